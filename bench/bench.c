@@ -0,0 +1,351 @@
+/**
+ * @file bench.c
+ * @brief Benchmark controller, worker pool and statistics table.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+static void bench_cycle_overhead(void);
+#if START_USING_TRACE
+static void bench_trace_record(void);
+#endif
+
+/** All cases, executed in order by the controller thread. */
+static const struct bench_case bench_cases[] =
+{
+    { "cycle counter read",   bench_cycle_overhead },
+#if START_USING_TRACE
+    { "trace record",         bench_trace_record   },
+#endif
+    { "task switch (yield)",  bench_task_switch    },
+    { "preemption (tick)",    bench_preemption     },
+    { "sem release->take",    bench_sem_shuffle    },
+#if START_USING_THREAD_NOTIFY
+    { NULL,                   bench_notify_shuffle },
+#endif
+#if START_USING_WAITSET
+    { "waitset sem->take",    bench_waitset_shuffle },
+#endif
+    { "deadlock break (PI)",  bench_deadlock_break },
+    { "msgqueue latency",     bench_msg_latency    },
+    { NULL,                   bench_mem_copy       },
+    { NULL,                   bench_mq_zero_copy   },
+    { NULL,                   bench_mailbox        },
+    { NULL,                   bench_ringbuf        },
+    { NULL,                   bench_stream         },
+    { NULL,                   bench_vmsgqueue      },
+    { NULL,                   bench_prioqueue      },
+    { NULL,                   bench_timer_insert   },
+    { NULL,                   bench_tick_wakeup    },
+    { NULL,                   bench_sem_waiters    },
+    { NULL,                   bench_mutex_paths    },
+    { NULL,                   bench_rwlock_readers },
+    { NULL,                   bench_cond_broadcast },
+    { NULL,                   bench_barrier_phase  },
+    { NULL,                   bench_sched_lookup   },
+};
+
+static s_uint32_t bench_samples[START_BENCH_SAMPLES];
+static s_uint32_t bench_nsamples;
+
+static s_thread   bench_ctrl_thread;
+static s_uint8_t  bench_ctrl_stack[START_BENCH_STACK_SIZE];
+
+static s_thread   bench_workers[BENCH_WORKER_MAX];
+static s_uint8_t  bench_worker_stacks[BENCH_WORKER_MAX][START_BENCH_STACK_SIZE];
+static s_sem      bench_done_sem;
+
+/**
+ * @brief Drop all recorded samples.
+ */
+void bench_reset(void)
+{
+    bench_nsamples = 0;
+}
+
+/**
+ * @brief Record one sample (ignored once the buffer is full).
+ */
+void bench_record(s_uint32_t value)
+{
+    if (bench_nsamples < START_BENCH_SAMPLES)
+        bench_samples[bench_nsamples++] = value;
+}
+
+/**
+ * @brief Record a sample that timed ops operations, as the cost of one.
+ */
+void bench_record_batch(s_uint32_t value, s_uint32_t ops)
+{
+    bench_record((value + ops / 2) / ops);
+}
+
+/**
+ * @brief Number of samples recorded so far.
+ */
+s_uint32_t bench_count(void)
+{
+    return bench_nsamples;
+}
+
+/**
+ * @brief Initialize and start pool worker idx at given priority.
+ * @note Waits until the previous user of the slot has been reclaimed by idle.
+ */
+s_pthread bench_worker_start(int idx, void (*entry)(void), s_uint8_t priority)
+{
+    s_pthread t = &bench_workers[idx];
+
+    while (t->status != 0 && t->status != START_THREAD_DELETED)
+        s_delay(1);
+
+    s_thread_init(t, entry, bench_worker_stacks[idx], START_BENCH_STACK_SIZE, priority, 10);
+    s_thread_startup(t);
+    return t;
+}
+
+/**
+ * @brief Signal the controller that the calling worker finished.
+ */
+void bench_worker_done(void)
+{
+    s_sem_release(&bench_done_sem);
+}
+
+/**
+ * @brief Block the controller until count workers called bench_worker_done().
+ */
+void bench_worker_join(int count)
+{
+    while (count--)
+        s_sem_take(&bench_done_sem, START_WAITING_FOREVER);
+}
+
+/**
+ * @brief Print v right aligned in a column of given width.
+ */
+static void bench_print_col(s_uint32_t v, int width)
+{
+    char buf[12];
+    int  len = 0;
+
+    do
+    {
+        buf[len++] = (char)('0' + (v % 10));
+        v /= 10;
+    } while (v && len < (int)sizeof(buf));
+
+    while (width-- > len)
+        s_putc(' ');
+    while (len--)
+        s_putc(buf[len]);
+}
+
+/**
+ * @brief Print name left aligned in a column of given width.
+ */
+static void bench_print_name(const char *name, int width)
+{
+    while (*name && width > 0)
+    {
+        s_putc(*name++);
+        width--;
+    }
+    while (width-- > 0)
+        s_putc(' ');
+}
+
+/**
+ * @brief Sort recorded samples ascending (insertion sort, small N).
+ */
+static void bench_sort(void)
+{
+    for (s_uint32_t i = 1; i < bench_nsamples; i++)
+    {
+        s_uint32_t v = bench_samples[i];
+        s_uint32_t j = i;
+        while (j > 0 && bench_samples[j - 1] > v)
+        {
+            bench_samples[j] = bench_samples[j - 1];
+            j--;
+        }
+        bench_samples[j] = v;
+    }
+}
+
+/**
+ * @brief Print the table header.
+ */
+static void bench_print_header(void)
+{
+    s_printf("\r\nStaRT kernel benchmark (unit: %s, %d samples/case)\r\n",
+             START_BENCH_UNIT, START_BENCH_SAMPLES);
+    s_printf("case                         n     min     avg     p50     p90     p99     max\r\n");
+    s_printf("------------------------------------------------------------------------------\r\n");
+}
+
+/**
+ * @brief Print one statistics row (no line end) and reset the samples.
+ * @return Median sample, 0 if none were recorded.
+ */
+static s_uint32_t bench_print_row(const char *name)
+{
+    s_uint64_t sum = 0;
+    s_uint32_t n   = bench_nsamples;
+    s_uint32_t p50;
+
+    bench_print_name(name, 24);
+    if (n == 0)
+    {
+        s_printf("     0  (no samples)");
+        return 0;
+    }
+
+    bench_sort();
+    for (s_uint32_t i = 0; i < n; i++)
+        sum += bench_samples[i];
+
+    bench_print_col(n, 6);
+    bench_print_col(bench_samples[0], 8);
+    bench_print_col((s_uint32_t)(sum / n), 8);
+    bench_print_col(bench_samples[n * 50 / 100], 8);
+    bench_print_col(bench_samples[n * 90 / 100], 8);
+    bench_print_col(bench_samples[n * 99 / 100], 8);
+    bench_print_col(bench_samples[n - 1], 8);
+    p50 = bench_samples[n * 50 / 100];
+    bench_reset();
+    return p50;
+}
+
+/**
+ * @brief Print one statistics row for the recorded samples and reset them.
+ */
+void bench_report(const char *name)
+{
+    bench_print_row(name);
+    s_printf("\r\n");
+}
+
+/**
+ * @brief Statistics row followed by the median throughput of bytes per sample.
+ */
+void bench_report_rate(const char *name, s_uint32_t bytes)
+{
+    s_uint32_t p50 = bench_print_row(name);
+
+    if (p50)
+        s_printf("  %d MB/s",
+                 (int)((s_uint64_t)bytes * START_BENCH_CLOCK_MHZ / p50));
+    s_printf("\r\n");
+}
+
+/**
+ * @brief Build a row label "prefix" followed by decimal n (static buffer).
+ */
+const char *bench_label(const char *prefix, s_uint32_t n)
+{
+    static char label[32];
+    char digits[12];
+    int  len = 0;
+    int  pos = 0;
+
+    while (*prefix && pos < (int)sizeof(label) - 1)
+        label[pos++] = *prefix++;
+    do
+    {
+        digits[len++] = (char)('0' + (n % 10));
+        n /= 10;
+    } while (n && len < (int)sizeof(digits));
+    while (len-- && pos < (int)sizeof(label) - 1)
+        label[pos++] = digits[len];
+    label[pos] = '\0';
+    return label;
+}
+
+/**
+ * @brief Cost of back-to-back counter reads (baseline for other rows).
+ */
+static void bench_cycle_overhead(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        bench_record(s_cycle_get() - t0);
+    }
+}
+
+#if START_USING_TRACE
+/**
+ * @brief Cost of one trace event; tracing stays off for the other cases.
+ */
+static void bench_trace_record(void)
+{
+    s_trace_start();
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        S_TRACE(S_TRACE_EV_SEM_RELEASE, &bench_done_sem, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+    s_trace_stop();
+}
+#endif
+
+/**
+ * @brief Weak completion hook.
+ */
+__weak void bench_finish(void)
+{
+}
+
+/**
+ * @brief Controller thread: run each case and print its row.
+ */
+static void bench_ctrl_entry(void)
+{
+    s_cycle_init();
+    bench_print_header();
+
+    for (unsigned i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+    {
+        bench_reset();
+        bench_cases[i].run();
+        /* Cases without a name report their own rows. */
+        if (bench_cases[i].name)
+            bench_report(bench_cases[i].name);
+    }
+
+    bench_finish();
+}
+
+/**
+ * @brief Create the benchmark controller thread.
+ */
+s_status bench_init(void)
+{
+    s_status ret;
+
+    s_sem_init(&bench_done_sem, 0, START_IPC_FLAG_FIFO);
+#if START_USING_TRACE
+    /* Kernel rows are measured without tracing (see bench_trace_record). */
+    s_trace_stop();
+#endif
+
+    ret = s_thread_init(&bench_ctrl_thread,
+                        bench_ctrl_entry,
+                        bench_ctrl_stack,
+                        sizeof(bench_ctrl_stack),
+                        BENCH_PRIO_CTRL,
+                        10);
+    if (ret != S_OK)
+        return ret;
+    return s_thread_startup(&bench_ctrl_thread);
+}
+
+#endif /* START_USING_BENCH */
@@ -0,0 +1,110 @@
+/**
+ * @file bench.h
+ * @brief Kernel benchmark suite (Rhealstone-style) shared helpers.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Timing uses s_cycle_get(): DWT CYCCNT on Cortex-M3, nanoseconds on host.
+ *   Each case runs its worker threads to completion, recording one sample per
+ *   iteration; the controller thread then prints a min/avg/percentile row.
+ *   Operations that cost about as much as one counter read are timed in
+ *   batches of START_BENCH_BATCH and recorded per operation.
+ */
+
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include "start.h"
+
+#ifndef START_BENCH_SAMPLES
+#define START_BENCH_SAMPLES     256   /**< Samples (iterations) per case */
+#endif
+#ifndef START_BENCH_STACK_SIZE
+#define START_BENCH_STACK_SIZE  512   /**< Stack size of each bench thread */
+#endif
+#ifndef START_BENCH_TIMERS
+#define START_BENCH_TIMERS      64    /**< Largest armed timer population */
+#endif
+#ifndef START_BENCH_WORKERS
+#define START_BENCH_WORKERS     4     /**< Worker threads available to a case (>= 4) */
+#endif
+#ifndef START_BENCH_UNIT
+#define START_BENCH_UNIT        "cyc" /**< Unit printed in the table header */
+#endif
+#ifndef START_BENCH_BATCH
+#define START_BENCH_BATCH       16    /**< Operations timed per sample by batched rows */
+#endif
+#ifndef START_BENCH_CLOCK_MHZ
+#define START_BENCH_CLOCK_MHZ   72    /**< Sample units per microsecond (MB/s rows) */
+#endif
+
+#define BENCH_WORKER_MAX        START_BENCH_WORKERS
+#define BENCH_PRIO_CTRL         1     /**< Controller thread priority */
+
+/**
+ * @brief One benchmark case (run from the controller thread).
+ */
+struct bench_case
+{
+    const char *name;     /**< Row label (NULL: case calls bench_report itself) */
+    void      (*run)(void);
+};
+
+/* Sample collection */
+void bench_reset(void);
+void bench_record(s_uint32_t value);
+void bench_record_batch(s_uint32_t value, s_uint32_t ops);
+s_uint32_t bench_count(void);
+void bench_report(const char *name);
+void bench_report_rate(const char *name, s_uint32_t bytes);
+const char *bench_label(const char *prefix, s_uint32_t n);
+
+/* Worker thread pool (index 0..BENCH_WORKER_MAX-1) */
+s_pthread bench_worker_start(int idx, void (*entry)(void), s_uint8_t priority);
+void      bench_worker_done(void);
+void      bench_worker_join(int count);
+
+/**
+ * @brief Create the controller thread that runs all cases once.
+ * @return S_OK on success.
+ */
+s_status bench_init(void);
+
+/**
+ * @brief Weak hook invoked after the last table row (host BSP exits here).
+ */
+void bench_finish(void);
+
+/* Rhealstone cases (bench_rhealstone.c) */
+void bench_task_switch(void);
+void bench_preemption(void);
+void bench_sem_shuffle(void);
+void bench_notify_shuffle(void);
+void bench_waitset_shuffle(void);
+void bench_deadlock_break(void);
+void bench_msg_latency(void);
+
+/* IPC data paths (bench_ipc.c) */
+void bench_mem_copy(void);
+void bench_mq_zero_copy(void);
+void bench_mailbox(void);
+void bench_ringbuf(void);
+void bench_stream(void);
+void bench_vmsgqueue(void);
+void bench_prioqueue(void);
+
+/* Kernel internals (bench_timer.c, bench_sched.c) */
+void bench_timer_insert(void);
+void bench_tick_wakeup(void);
+void bench_sched_lookup(void);
+void bench_sem_waiters(void);
+
+/* Locks (bench_sync.c) */
+void bench_mutex_paths(void);
+void bench_rwlock_readers(void);
+void bench_cond_broadcast(void);
+void bench_barrier_phase(void);
+
+#endif /* __BENCH_H_ */
@@ -0,0 +1,392 @@
+/**
+ * @file bench_ipc.c
+ * @brief IPC data path benchmarks: payload copy routines, copying vs.
+ *        zero-copy message queue, 4-byte message queue vs. mailbox, byte
+ *        streaming through a message queue vs. the SPSC ring buffer,
+ *        variable-length chunks through a message queue, a stream and a
+ *        variable-length message queue, priority queue cost vs. depth.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   One thread sends and receives back to back, so a sample is the data
+ *   path alone (no context switch): enqueue + dequeue of one frame.
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+#define BENCH_COPY_MAX   1024
+
+static s_uint32_t bench_copy_src[BENCH_COPY_MAX / 4];
+static s_uint32_t bench_copy_dst[BENCH_COPY_MAX / 4];
+
+/**
+ * @brief Byte loop the message queue used before s_memcpy() (baseline).
+ */
+static void bench_copy_bytes(s_uint8_t *dst, const s_uint8_t *src, s_uint16_t len)
+{
+    while (len--) *dst++ = *src++;
+}
+
+/**
+ * @brief Sample one size-byte copy with the byte loop and with s_memcpy().
+ */
+static void bench_copy_n(s_uint16_t size, int word)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        if (word)
+            s_memcpy(bench_copy_dst, bench_copy_src, size);
+        else
+            bench_copy_bytes((s_uint8_t *)bench_copy_dst, (const s_uint8_t *)bench_copy_src, size);
+        bench_record(s_cycle_get() - t0);
+    }
+}
+
+/**
+ * @brief Rows for 4, 16, 64, 256 and 1024 byte payloads.
+ */
+void bench_mem_copy(void)
+{
+    for (s_uint16_t size = 4; size <= BENCH_COPY_MAX; size *= 4)
+    {
+        bench_copy_n(size, 0);
+        bench_report(bench_label("copy bytes B=", size));
+        bench_copy_n(size, 1);
+        bench_report(bench_label("s_memcpy B=", size));
+    }
+}
+
+#if START_USING_MESSAGEQUEUE
+#define BENCH_FRAME_MAX  256
+#define BENCH_FRAME_NR   4
+
+static s_msgqueue bench_frame_mq;
+static s_uint8_t  bench_frame_pool[START_MSGQ_POOL_SIZE(BENCH_FRAME_MAX, BENCH_FRAME_NR)];
+static s_uint32_t bench_frame_tx[BENCH_FRAME_MAX / 4];
+static s_uint32_t bench_frame_rx[BENCH_FRAME_MAX / 4];
+
+/**
+ * @brief Sample send + recv of one size-byte frame through local buffers.
+ */
+static void bench_mq_copy_n(s_uint16_t size)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        bench_frame_tx[0] = (s_uint32_t)i;
+        s_msgqueue_send(&bench_frame_mq, bench_frame_tx, size);
+        s_msgqueue_recv(&bench_frame_mq, bench_frame_rx, size, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+}
+
+/**
+ * @brief Sample the same frame produced and consumed in the pool slot.
+ */
+static void bench_mq_zero_copy_n(void)
+{
+    void *frame;
+
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_msgqueue_alloc(&bench_frame_mq, &frame, 0);
+        *(s_uint32_t *)frame = (s_uint32_t)i;
+        s_msgqueue_commit(&bench_frame_mq, frame);
+        s_msgqueue_recv_ptr(&bench_frame_mq, &frame, 0);
+        bench_frame_rx[0] = *(s_uint32_t *)frame;
+        s_msgqueue_release(&bench_frame_mq, frame);
+        bench_record(s_cycle_get() - t0);
+    }
+}
+#endif
+
+/**
+ * @brief Rows for 64 and 256 byte frames, copying and in place.
+ */
+void bench_mq_zero_copy(void)
+{
+#if START_USING_MESSAGEQUEUE
+    for (s_uint16_t size = 64; size <= BENCH_FRAME_MAX; size *= 4)
+    {
+        s_msgqueue_init(&bench_frame_mq, bench_frame_pool, size,
+                        sizeof(bench_frame_pool), START_IPC_FLAG_FIFO);
+
+        bench_mq_copy_n(size);
+        bench_report(bench_label("mq copy B=", size));
+        bench_mq_zero_copy_n();
+        bench_report(bench_label("mq zero-copy B=", size));
+
+        s_msgqueue_delete(&bench_frame_mq);
+    }
+#endif
+}
+
+#define BENCH_WORD_NR    4
+
+#if START_USING_MESSAGEQUEUE
+static s_msgqueue bench_word_mq;
+static s_uint8_t  bench_word_pool[START_MSGQ_POOL_SIZE(4, BENCH_WORD_NR)];
+#endif
+#if START_USING_MAILBOX
+static s_mailbox  bench_word_mb;
+static s_uint32_t bench_word_slots[BENCH_WORD_NR];
+#endif
+
+/**
+ * @brief One 32-bit value (e.g. a buffer pointer) through a msg_size=4
+ *        message queue and through a mailbox.
+ */
+void bench_mailbox(void)
+{
+    s_uint32_t value;
+
+#if START_USING_MESSAGEQUEUE
+    s_msgqueue_init(&bench_word_mq, bench_word_pool, 4,
+                    sizeof(bench_word_pool), START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        value = (s_uint32_t)i;
+        s_msgqueue_send(&bench_word_mq, &value, 4);
+        s_msgqueue_recv(&bench_word_mq, &value, 4, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report("mq send+recv B=4");
+    s_msgqueue_delete(&bench_word_mq);
+#endif
+
+#if START_USING_MAILBOX
+    s_mailbox_init(&bench_word_mb, bench_word_slots, BENCH_WORD_NR, START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_mailbox_send(&bench_word_mb, (s_uint32_t)i);
+        s_mailbox_recv(&bench_word_mb, &value, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report("mailbox send+recv");
+    s_mailbox_delete(&bench_word_mb);
+#endif
+    (void)value;
+}
+
+#define BENCH_STREAM_MAX  1024
+#define BENCH_STREAM_MQ   64
+
+#if START_USING_RINGBUF
+static s_ringbuf  bench_stream_rb;
+static s_uint8_t  bench_stream_ring[BENCH_STREAM_MAX];
+#endif
+#if START_USING_MESSAGEQUEUE
+static s_msgqueue bench_stream_mq;
+static s_uint8_t  bench_stream_pool[START_MSGQ_POOL_SIZE(1, BENCH_STREAM_MQ)];
+#endif
+
+/**
+ * @brief Byte stream throughput: one message per byte vs. ring buffer blocks.
+ * @note A sample writes then reads size bytes from the same thread, i.e. the
+ *       producer and consumer data paths without a wakeup.
+ */
+void bench_ringbuf(void)
+{
+    s_uint8_t *src = (s_uint8_t *)bench_copy_src;
+    s_uint8_t *dst = (s_uint8_t *)bench_copy_dst;
+
+#if START_USING_MESSAGEQUEUE
+    s_msgqueue_init(&bench_stream_mq, bench_stream_pool, 1,
+                    sizeof(bench_stream_pool), START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        for (int j = 0; j < BENCH_STREAM_MQ; j++)
+            s_msgqueue_send(&bench_stream_mq, &src[j], 1);
+        for (int j = 0; j < BENCH_STREAM_MQ; j++)
+            s_msgqueue_recv(&bench_stream_mq, &dst[j], 1, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report_rate(bench_label("mq 1-byte msgs B=", BENCH_STREAM_MQ), BENCH_STREAM_MQ);
+    s_msgqueue_delete(&bench_stream_mq);
+#endif
+
+#if START_USING_RINGBUF
+    s_ringbuf_init(&bench_stream_rb, bench_stream_ring, 1, BENCH_STREAM_MAX, 1);
+    for (s_uint32_t size = 16; size <= BENCH_STREAM_MAX; size *= 4)
+    {
+        for (int i = 0; i < START_BENCH_SAMPLES; i++)
+        {
+            s_uint32_t t0 = s_cycle_get();
+            s_ringbuf_write(&bench_stream_rb, src, size);
+            s_ringbuf_read(&bench_stream_rb, dst, size, 0);
+            bench_record(s_cycle_get() - t0);
+        }
+        bench_report_rate(bench_label("ringbuf B=", size), size);
+    }
+#endif
+    (void)src;
+    (void)dst;
+}
+
+#define BENCH_CHUNK_NR    16
+#define BENCH_CHUNK_MAX   32
+#define BENCH_CHUNK_BYTES 256
+
+/* Parser-style chunk lengths, 2..30 bytes, BENCH_CHUNK_BYTES in total. */
+static const s_uint8_t bench_chunk_len[BENCH_CHUNK_NR] =
+{
+    4, 28, 8, 24, 12, 20, 16, 16, 30, 2, 26, 6, 22, 10, 18, 14
+};
+
+#if START_USING_STREAM
+static s_stream   bench_chunk_st;
+static s_uint8_t  bench_chunk_buf[BENCH_CHUNK_BYTES];
+#endif
+#if START_USING_MESSAGEQUEUE
+static s_msgqueue bench_chunk_mq;
+static s_uint8_t  bench_chunk_pool[START_MSGQ_POOL_SIZE(BENCH_CHUNK_MAX, BENCH_CHUNK_NR)];
+#endif
+
+/**
+ * @brief 16 variable-length chunks (256 bytes) queued, then drained.
+ * @note The row label carries the storage each object needs for the same
+ *       burst: fixed slots of the longest chunk plus a node header per
+ *       message, vs. the payload bytes alone. The stream drains the burst
+ *       with one read (two copies at most).
+ */
+void bench_stream(void)
+{
+    s_uint8_t *src = (s_uint8_t *)bench_copy_src;
+    s_uint8_t *dst = (s_uint8_t *)bench_copy_dst;
+
+#if START_USING_MESSAGEQUEUE
+    s_msgqueue_init(&bench_chunk_mq, bench_chunk_pool, BENCH_CHUNK_MAX,
+                    sizeof(bench_chunk_pool), START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_uint32_t off = 0;
+        for (int j = 0; j < BENCH_CHUNK_NR; j++)
+        {
+            s_msgqueue_send(&bench_chunk_mq, src + off, bench_chunk_len[j]);
+            off += bench_chunk_len[j];
+        }
+        off = 0;
+        for (int j = 0; j < BENCH_CHUNK_NR; j++)
+        {
+            s_msgqueue_recv(&bench_chunk_mq, dst + off, bench_chunk_len[j], 0);
+            off += bench_chunk_len[j];
+        }
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report_rate(bench_label("mq chunks RAM=", sizeof(bench_chunk_pool)), BENCH_CHUNK_BYTES);
+    s_msgqueue_delete(&bench_chunk_mq);
+#endif
+
+#if START_USING_STREAM
+    s_stream_init(&bench_chunk_st, bench_chunk_buf, sizeof(bench_chunk_buf),
+                  1, START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_uint32_t off = 0;
+        for (int j = 0; j < BENCH_CHUNK_NR; j++)
+        {
+            s_stream_write(&bench_chunk_st, src + off, bench_chunk_len[j], 0);
+            off += bench_chunk_len[j];
+        }
+        s_stream_read(&bench_chunk_st, dst, BENCH_CHUNK_BYTES, 0);
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report_rate(bench_label("stream chunks RAM=", sizeof(bench_chunk_buf)), BENCH_CHUNK_BYTES);
+    s_stream_delete(&bench_chunk_st);
+#endif
+    (void)src;
+    (void)dst;
+}
+
+#if START_USING_VMSGQUEUE
+static s_vmsgqueue bench_chunk_vq;
+static s_uint8_t   bench_chunk_vpool[START_VMSGQ_POOL_SIZE(BENCH_CHUNK_BYTES, BENCH_CHUNK_NR)];
+#endif
+
+/**
+ * @brief The bench_stream() burst as length-prefixed messages: message
+ *        boundaries are kept at a 2-byte cost per message.
+ */
+void bench_vmsgqueue(void)
+{
+#if START_USING_VMSGQUEUE
+    s_uint8_t *src = (s_uint8_t *)bench_copy_src;
+    s_uint8_t *dst = (s_uint8_t *)bench_copy_dst;
+    s_uint16_t len;
+
+    s_vmsgqueue_init(&bench_chunk_vq, bench_chunk_vpool, sizeof(bench_chunk_vpool),
+                     START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_uint32_t off = 0;
+        for (int j = 0; j < BENCH_CHUNK_NR; j++)
+        {
+            s_vmsgqueue_send(&bench_chunk_vq, src + off, bench_chunk_len[j]);
+            off += bench_chunk_len[j];
+        }
+        off = 0;
+        for (int j = 0; j < BENCH_CHUNK_NR; j++)
+        {
+            s_vmsgqueue_recv(&bench_chunk_vq, dst + off, BENCH_CHUNK_MAX, &len, 0);
+            off += len;
+        }
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report_rate(bench_label("vmq chunks RAM=", sizeof(bench_chunk_vpool)), BENCH_CHUNK_BYTES);
+    s_vmsgqueue_delete(&bench_chunk_vq);
+#endif
+}
+
+#define BENCH_PRIOQ_DEPTH  32
+
+#if START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE
+static s_prioqueue bench_prioq;
+static s_uint8_t   bench_prioq_pool[START_MSGQ_POOL_SIZE(4, BENCH_PRIOQ_DEPTH + 1)];
+#endif
+
+/**
+ * @brief One send (cycling priorities) + recv of the most urgent message
+ *        with 0, 8 and 32 messages already queued across all levels: the
+ *        rows stay flat because both ends are O(1) in the queue depth.
+ */
+void bench_prioqueue(void)
+{
+#if START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE
+    s_uint32_t value = 0;
+    s_uint8_t  prio;
+
+    for (int depth = 0; depth <= BENCH_PRIOQ_DEPTH; depth = depth ? depth * 4 : 8)
+    {
+        s_prioqueue_init(&bench_prioq, bench_prioq_pool, 4,
+                         sizeof(bench_prioq_pool), START_IPC_FLAG_FIFO);
+        for (int i = 0; i < depth; i++)
+            s_prioqueue_send(&bench_prioq, &value, 4, (s_uint8_t)(i % START_PRIOQ_LEVELS));
+
+        for (int i = 0; i < START_BENCH_SAMPLES; i++)
+        {
+            s_uint32_t t0 = s_cycle_get();
+            value = (s_uint32_t)i;
+            s_prioqueue_send(&bench_prioq, &value, 4, (s_uint8_t)(i % START_PRIOQ_LEVELS));
+            s_prioqueue_recv(&bench_prioq, &value, 4, &prio, 0);
+            bench_record(s_cycle_get() - t0);
+        }
+        bench_report(bench_label("prioq send+recv depth=", depth));
+        s_prioqueue_delete(&bench_prioq);
+    }
+    (void)prio;
+#endif
+}
+
+#endif /* START_USING_BENCH */
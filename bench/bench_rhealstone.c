@@ -0,0 +1,370 @@
+/**
+ * @file bench_rhealstone.c
+ * @brief Rhealstone cases: task switch, preemption, semaphore shuffle,
+ *        deadlock break and intertask message latency, plus the semaphore
+ *        shuffle through a direct thread notification and a wait set.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Priorities: lower number = higher priority. Workers use 4..7 so the
+ *   controller (1) stays blocked in bench_worker_join() while a case runs.
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+#define BENCH_PRIO_HIGH  4
+#define BENCH_PRIO_MED   5
+#define BENCH_PRIO_LOW   7
+
+static volatile s_uint32_t bench_t0;
+static volatile s_uint32_t bench_iter;
+static volatile s_uint8_t  bench_armed;
+static volatile s_uint8_t  bench_stop;
+
+static s_sem   bench_sem_a;
+static s_sem   bench_sem_b;
+static s_mutex bench_mutex;
+
+/* ---------------------------------------------------------------------------
+ * Task switch: two equal-priority threads alternate via s_thread_yield().
+ * Sample = yield in one thread -> return to the other.
+ * ------------------------------------------------------------------------- */
+static void bench_switch_entry(void)
+{
+    while (bench_iter < START_BENCH_SAMPLES)
+    {
+        if (bench_armed)
+        {
+            bench_record(s_cycle_get() - bench_t0);
+            bench_iter++;
+        }
+        bench_armed = 1;
+        bench_t0    = s_cycle_get();
+        s_thread_yield();
+    }
+    bench_worker_done();
+}
+
+void bench_task_switch(void)
+{
+    bench_iter  = 0;
+    bench_armed = 0;
+    bench_worker_start(0, bench_switch_entry, BENCH_PRIO_MED);
+    bench_worker_start(1, bench_switch_entry, BENCH_PRIO_MED);
+    bench_worker_join(2);
+}
+
+/* ---------------------------------------------------------------------------
+ * Preemption: low thread spins publishing timestamps, high thread sleeps one
+ * tick. Sample = last low timestamp -> high thread running (tick ISR,
+ * timer expiry and switch included).
+ * ------------------------------------------------------------------------- */
+static void bench_preempt_low_entry(void)
+{
+    while (!bench_stop)
+        bench_t0 = s_cycle_get();
+    bench_worker_done();
+}
+
+static void bench_preempt_high_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_thread_sleep(1);
+        bench_record(s_cycle_get() - bench_t0);
+    }
+    bench_stop = 1;
+    bench_worker_done();
+}
+
+void bench_preemption(void)
+{
+    bench_stop = 0;
+    bench_t0   = s_cycle_get();
+    bench_worker_start(0, bench_preempt_low_entry, BENCH_PRIO_LOW);
+    bench_worker_start(1, bench_preempt_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_join(2);
+}
+
+/* ---------------------------------------------------------------------------
+ * Semaphore shuffle: high thread blocks in s_sem_take, low thread releases.
+ * Sample = s_sem_release() call -> s_sem_take() return in the waiter.
+ * ------------------------------------------------------------------------- */
+static void bench_sem_high_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_sem_take(&bench_sem_a, START_WAITING_FOREVER);
+        bench_record(s_cycle_get() - bench_t0);
+    }
+    bench_worker_done();
+}
+
+static void bench_sem_low_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        bench_t0 = s_cycle_get();
+        s_sem_release(&bench_sem_a);
+    }
+    bench_worker_done();
+}
+
+void bench_sem_shuffle(void)
+{
+    s_sem_init(&bench_sem_a, 0, START_IPC_FLAG_FIFO);
+    bench_worker_start(0, bench_sem_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_sem_low_entry, BENCH_PRIO_LOW);
+    bench_worker_join(2);
+    s_sem_delete(&bench_sem_a);
+}
+
+/* ---------------------------------------------------------------------------
+ * Notify shuffle: the semaphore shuffle with the waiter blocked in
+ * s_thread_notify_wait() and the releaser calling s_thread_notify().
+ * Sample = s_thread_notify() call -> s_thread_notify_wait() return.
+ * ------------------------------------------------------------------------- */
+#if START_USING_THREAD_NOTIFY
+static s_pthread bench_notify_waiter;
+
+static void bench_notify_high_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_thread_notify_wait(0xFFFFFFFF, NULL, START_WAITING_FOREVER);
+        bench_record(s_cycle_get() - bench_t0);
+    }
+    bench_worker_done();
+}
+
+static void bench_notify_low_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        bench_t0 = s_cycle_get();
+        s_thread_notify(bench_notify_waiter, 0, START_NOTIFY_INCREMENT);
+    }
+    bench_worker_done();
+}
+#endif
+
+/**
+ * @brief Rows: the shuffle above, then signal + receive in one thread
+ *        (no switch) through a semaphore and through a notification, which
+ *        leaves the kernel path alone. Those two rows are close to the
+ *        counter read, so each sample times START_BENCH_BATCH pairs.
+ */
+void bench_notify_shuffle(void)
+{
+#if START_USING_THREAD_NOTIFY
+    s_pthread self = s_thread_get();
+
+    bench_notify_waiter = bench_worker_start(0, bench_notify_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_notify_low_entry, BENCH_PRIO_LOW);
+    bench_worker_join(2);
+    bench_report("notify->wait");
+
+    s_sem_init(&bench_sem_a, 0, START_IPC_FLAG_FIFO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        for (int j = 0; j < START_BENCH_BATCH; j++)
+        {
+            s_sem_release(&bench_sem_a);
+            s_sem_take(&bench_sem_a, START_WAITING_FOREVER);
+        }
+        bench_record_batch(s_cycle_get() - t0, START_BENCH_BATCH);
+    }
+    bench_report("sem release+take");
+    s_sem_delete(&bench_sem_a);
+
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        for (int j = 0; j < START_BENCH_BATCH; j++)
+        {
+            s_thread_notify(self, 0, START_NOTIFY_INCREMENT);
+            s_thread_notify_wait(0xFFFFFFFF, NULL, START_WAITING_FOREVER);
+        }
+        bench_record_batch(s_cycle_get() - t0, START_BENCH_BATCH);
+    }
+    bench_report("notify+wait");
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * Wait set shuffle: the semaphore shuffle with the waiter blocked in
+ * s_waitset_wait() on BENCH_WAITSET_SEMS semaphores and the releaser always
+ * signalling the last one. Sample = s_sem_release() call -> s_sem_take()
+ * (non-blocking, on the reported member) return in the waiter.
+ * ------------------------------------------------------------------------- */
+#if START_USING_WAITSET
+#define BENCH_WAITSET_SEMS  4
+
+static s_waitset bench_waitset;
+static s_sem     bench_waitset_sem[BENCH_WAITSET_SEMS];
+
+static void bench_waitset_high_entry(void)
+{
+    void *ready;
+
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_waitset_wait(&bench_waitset, &ready, START_WAITING_FOREVER);
+        s_sem_take((s_psem)ready, START_WAITING_NO);
+        bench_record(s_cycle_get() - bench_t0);
+    }
+    bench_worker_done();
+}
+
+static void bench_waitset_low_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        bench_t0 = s_cycle_get();
+        s_sem_release(&bench_waitset_sem[BENCH_WAITSET_SEMS - 1]);
+    }
+    bench_worker_done();
+}
+#endif
+
+void bench_waitset_shuffle(void)
+{
+#if START_USING_WAITSET
+    s_waitset_init(&bench_waitset, START_IPC_FLAG_FIFO);
+    for (int i = 0; i < BENCH_WAITSET_SEMS; i++)
+    {
+        s_sem_init(&bench_waitset_sem[i], 0, START_IPC_FLAG_FIFO);
+        s_waitset_add_sem(&bench_waitset, &bench_waitset_sem[i]);
+    }
+    bench_worker_start(0, bench_waitset_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_waitset_low_entry, BENCH_PRIO_LOW);
+    bench_worker_join(2);
+    for (int i = 0; i < BENCH_WAITSET_SEMS; i++)
+        s_sem_delete(&bench_waitset_sem[i]);
+    s_waitset_delete(&bench_waitset);
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ * Deadlock break: low owns the mutex, high blocks on it, a medium thread is
+ * ready and would starve low without priority inheritance.
+ * Sample = high s_mutex_take() call -> mutex handed over to high.
+ * ------------------------------------------------------------------------- */
+static void bench_dl_low_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        s_sem_release(&bench_sem_a);    /* wake high: preempts us */
+        s_mutex_release(&bench_mutex);  /* boosted: runs before medium */
+    }
+    bench_worker_done();
+}
+
+static void bench_dl_med_entry(void)
+{
+    while (1)
+    {
+        s_sem_take(&bench_sem_b, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+        while (bench_armed)
+            ;
+    }
+    bench_worker_done();
+}
+
+static void bench_dl_high_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_sem_take(&bench_sem_a, START_WAITING_FOREVER);
+
+        bench_armed = 1;
+        s_sem_release(&bench_sem_b);    /* medium ready, but lower than us */
+
+        bench_t0 = s_cycle_get();
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        bench_record(s_cycle_get() - bench_t0);
+
+        bench_armed = 0;
+        s_mutex_release(&bench_mutex);
+    }
+    bench_stop = 1;
+    s_sem_release(&bench_sem_b);
+    bench_worker_done();
+}
+
+void bench_deadlock_break(void)
+{
+    bench_stop  = 0;
+    bench_armed = 0;
+    s_sem_init(&bench_sem_a, 0, START_IPC_FLAG_FIFO);
+    s_sem_init(&bench_sem_b, 0, START_IPC_FLAG_FIFO);
+    s_mutex_init(&bench_mutex, START_IPC_FLAG_PRIO);
+    bench_worker_start(0, bench_dl_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_dl_med_entry, BENCH_PRIO_MED);
+    bench_worker_start(2, bench_dl_low_entry, BENCH_PRIO_LOW);
+    bench_worker_join(3);
+    s_mutex_delete(&bench_mutex);
+    s_sem_delete(&bench_sem_b);
+    s_sem_delete(&bench_sem_a);
+}
+
+/* ---------------------------------------------------------------------------
+ * Intertask message latency: 16-byte message carrying its send timestamp.
+ * Sample = s_msgqueue_send() call -> s_msgqueue_recv() return in receiver.
+ * ------------------------------------------------------------------------- */
+#if START_USING_MESSAGEQUEUE
+struct bench_msg
+{
+    s_uint32_t t0;
+    s_uint32_t payload[3];
+};
+
+static s_msgqueue bench_mq;
+static s_uint8_t  bench_mq_pool[START_MSGQ_POOL_SIZE(sizeof(struct bench_msg), 4)];
+
+static void bench_mq_recv_entry(void)
+{
+    struct bench_msg msg;
+
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_msgqueue_recv(&bench_mq, &msg, sizeof(msg), START_WAITING_FOREVER);
+        bench_record(s_cycle_get() - msg.t0);
+    }
+    bench_worker_done();
+}
+
+static void bench_mq_send_entry(void)
+{
+    struct bench_msg msg = { 0, { 1, 2, 3 } };
+
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        msg.t0 = s_cycle_get();
+        s_msgqueue_send(&bench_mq, &msg, sizeof(msg));
+    }
+    bench_worker_done();
+}
+#endif
+
+void bench_msg_latency(void)
+{
+#if START_USING_MESSAGEQUEUE
+    s_msgqueue_init(&bench_mq, bench_mq_pool, sizeof(struct bench_msg),
+                    sizeof(bench_mq_pool), START_IPC_FLAG_FIFO);
+    bench_worker_start(0, bench_mq_recv_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_mq_send_entry, BENCH_PRIO_LOW);
+    bench_worker_join(2);
+    s_msgqueue_delete(&bench_mq);
+#endif
+}
+
+#endif /* START_USING_BENCH */
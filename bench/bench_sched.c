@@ -0,0 +1,232 @@
+/**
+ * @file bench_sched.c
+ * @brief Scheduler benchmarks: tick ISR cost vs. threads woken in one tick,
+ *        highest-ready lookup cost vs. priority, semaphore block / wake cost
+ *        vs. waiters queued on a START_IPC_FLAG_PRIO semaphore (equal or
+ *        mixed priorities).
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   The controller injects the tick itself with IRQs disabled, so a sample
+ *   covers exactly one s_tick_increase(): time slice accounting, expiry of n
+ *   sleep timers and the rescheduling they request. The resulting context
+ *   switch is taken after the sample, when IRQs are enabled again.
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+#define BENCH_PRIO_WAKE    4
+#define BENCH_PRIO_WAITER  8   /**< Parked semaphore waiters (controller drops below) */
+#define BENCH_WAKE_AHEAD   16  /**< Ticks between two injected deadlines */
+#define BENCH_WAKE_ROUNDS  (START_BENCH_SAMPLES < 128 ? START_BENCH_SAMPLES : 128)
+
+extern volatile s_uint32_t s_tick;
+
+static volatile s_uint32_t bench_deadline;
+static volatile s_uint8_t  bench_stop;
+
+static s_sem bench_wait_sem;
+
+static void bench_wake_entry(void)
+{
+    while (!bench_stop)
+    {
+        s_int32_t ahead = (s_int32_t)(bench_deadline - s_tick_get());
+        s_thread_sleep(ahead > 0 ? (s_uint32_t)ahead : 1);
+    }
+    bench_worker_done();
+}
+
+/**
+ * @brief Wait until every worker armed its sleep timer.
+ * @note On a loaded host real ticks can catch up with the deadline while
+ *       workers are still being scheduled; the deadline is then moved ahead
+ *       (workers woken by the old one re-arm for the new one) and the scan
+ *       restarts.
+ */
+static void bench_wake_settle(s_pthread *th, s_uint32_t n)
+{
+    for (s_uint32_t i = 0; i < n; i++)
+    {
+        while (s_list_isempty(&th[i]->timer.row[0]))
+        {
+            s_delay(1);
+
+            s_uint32_t level = s_irq_disable();
+            if ((s_int32_t)(bench_deadline - 1 - s_tick) <= 0)
+            {
+                bench_deadline = s_tick + BENCH_WAKE_AHEAD;
+                i = 0;
+            }
+            s_irq_enable(level);
+        }
+    }
+}
+
+/**
+ * @brief Sample s_sched_switch() from a thread that stays highest ready.
+ * @note Idle (lowest priority) is the only other ready thread, so every call
+ *       is a pure lookup: one group scan plus, beyond 32 priorities, one
+ *       scan of the group word. A lookup costs about one counter read, so
+ *       each sample times START_BENCH_BATCH calls.
+ */
+static void bench_lookup_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        for (int j = 0; j < START_BENCH_BATCH; j++)
+            s_sched_switch();
+        bench_record_batch(s_cycle_get() - t0, START_BENCH_BATCH);
+    }
+    bench_worker_done();
+}
+
+/**
+ * @brief One row per sampled priority, spread over the whole range.
+ */
+void bench_sched_lookup(void)
+{
+    static const s_uint8_t div[] = { 0, 8, 4, 2, 1 };
+    s_uint8_t last = 0;
+
+    for (unsigned i = 0; i < sizeof(div) / sizeof(div[0]); i++)
+    {
+        /* 2 (just below the controller) ... MAX-2 (just above idle) */
+        s_uint8_t prio = div[i] ? START_THREAD_PRIORITY_MAX / div[i] - 2 : 2;
+        if (prio == last)
+            continue;
+        last = prio;
+
+        bench_worker_start(0, bench_lookup_entry, prio);
+        bench_worker_join(1);
+        bench_report(bench_label("sched lookup prio=", prio));
+    }
+}
+
+/**
+ * @brief Sample one tick interrupt that wakes n sleeping threads.
+ */
+static void bench_tick_wake_n(s_uint32_t n)
+{
+    s_pthread th[BENCH_WORKER_MAX];
+
+    bench_stop     = 0;
+    bench_deadline = s_tick_get() + BENCH_WAKE_AHEAD;
+    for (s_uint32_t i = 0; i < n; i++)
+        th[i] = bench_worker_start(i, bench_wake_entry, BENCH_PRIO_WAKE);
+
+    for (int round = 0; round <= BENCH_WAKE_ROUNDS; round++)
+    {
+        bench_wake_settle(th, n);
+        if (round == BENCH_WAKE_ROUNDS)
+            bench_stop = 1;
+
+        s_uint32_t level = s_irq_disable();
+
+        /* Fast-forward to the tick before the deadline (keeps wheels in step). */
+        while ((s_int32_t)(bench_deadline - 1 - s_tick) > 0)
+            s_tick_increase();
+        bench_deadline += BENCH_WAKE_AHEAD;
+
+        s_uint32_t t0 = s_cycle_get();
+        s_tick_increase();
+        s_uint32_t t1 = s_cycle_get();
+
+        s_irq_enable(level);
+
+        if (round < BENCH_WAKE_ROUNDS)
+            bench_record(t1 - t0);
+    }
+
+    bench_worker_join(n);
+}
+
+/**
+ * @brief One row per wakeup count: 1, 2, 4, ... BENCH_WORKER_MAX.
+ */
+void bench_tick_wakeup(void)
+{
+    for (s_uint32_t n = 1; n <= BENCH_WORKER_MAX; n *= 2)
+    {
+        bench_tick_wake_n(n);
+        bench_report(bench_label("tick ISR wake=", n));
+    }
+}
+
+static void bench_sem_wait_entry(void)
+{
+    while (1)
+    {
+        s_sem_take(&bench_wait_sem, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+    }
+    bench_worker_done();
+}
+
+/**
+ * @brief Sample release -> the head waiter takes, loops and blocks again,
+ *        with n waiters parked on a PRIO semaphore.
+ * @param mixed 0: all waiters share one priority. 1: the last one runs a
+ *        priority lower.
+ * @note Equal priorities are the common worker-pool case; each re-block
+ *       queues behind every other waiter. With the less urgent waiter at
+ *       the tail, a sorted list (START_IPC_WAIT_POOL 0) walks past the n - 2
+ *       equal ones on each re-block; per-priority heads append in O(1). The
+ *       controller runs just below the waiters, so both switches fall inside
+ *       the sample.
+ */
+static void bench_sem_waiters_n(s_uint32_t n, s_uint8_t mixed)
+{
+    s_pthread  self = s_thread_get();
+    s_uint8_t  prio = BENCH_PRIO_WAITER + 1 + mixed;
+
+    bench_stop = 0;
+    s_sem_init(&bench_wait_sem, 0, START_IPC_FLAG_PRIO);
+    for (s_uint32_t i = 0; i < n; i++)
+        bench_worker_start(i, bench_sem_wait_entry,
+                           (s_uint8_t)(BENCH_PRIO_WAITER + (mixed && i == n - 1)));
+
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+    s_sched_switch();   /* let every waiter run and park */
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_sem_release(&bench_wait_sem);
+        bench_record(s_cycle_get() - t0);
+    }
+
+    bench_stop = 1;
+    for (s_uint32_t i = 0; i < n; i++)
+        s_sem_release(&bench_wait_sem);
+    prio = BENCH_PRIO_CTRL;
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+
+    bench_worker_join(n);
+    s_sem_delete(&bench_wait_sem);
+}
+
+/**
+ * @brief One row per waiter count: 1, 4, 16, ... BENCH_WORKER_MAX, then the
+ *        same counts (from 4) with one less urgent waiter mixed in.
+ */
+void bench_sem_waiters(void)
+{
+    for (s_uint32_t n = 1; n <= BENCH_WORKER_MAX; n *= 4)
+    {
+        bench_sem_waiters_n(n, 0);
+        bench_report(bench_label("sem PRIO waiters=", n));
+    }
+    for (s_uint32_t n = 4; n <= BENCH_WORKER_MAX; n *= 4)
+    {
+        bench_sem_waiters_n(n, 1);
+        bench_report(bench_label("sem PRIO mixed=", n));
+    }
+}
+
+#endif /* START_USING_BENCH */
@@ -0,0 +1,380 @@
+/**
+ * @file bench_sync.c
+ * @brief Lock benchmarks: s_mutex take + release without and with a
+ *        waiter; read-side cost of s_rwlock vs. s_mutex with n
+ *        reader threads sharing one table; waking n threads that share a
+ *        mutex with one s_cond_broadcast vs. n semaphore releases; one
+ *        fan-out / fan-in phase through s_barrier vs. counting semaphores.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   The uncontended row takes and releases a free mutex back to back. The
+ *   contended row times release -> take return in a higher priority thread
+ *   that was blocked on the mutex (hand over, restore, one switch).
+ *
+ *   Readers share one priority and give up the CPU with s_thread_yield()
+ *   while still inside the read section, as a time slice end or a higher
+ *   priority thread does on a single core. Under s_rwlock the next reader
+ *   walks straight in; under s_mutex it blocks until the holder comes back.
+ *   A sample is one round (every reader completed one read) divided by n,
+ *   so 1e9 / sample is reads per second on the host.
+ *
+ *   The wakeup rows park n waiters just above the controller. A sample is
+ *   the controller taking the mutex, waking all n, releasing the mutex, and
+ *   every waiter having taken the mutex and blocked again. The phase rows
+ *   time one controller cycle: release n workers, each does its step, all
+ *   of them are back waiting for the next phase.
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+#define BENCH_PRIO_READER  6
+#define BENCH_READERS_MAX  16
+#define BENCH_TABLE_WORDS  32
+#define BENCH_PRIO_WAITER  8   /**< Parked waiters (controller drops below) */
+#define BENCH_PRIO_HIGH    4
+#define BENCH_PRIO_LOW     7
+
+static volatile s_uint8_t  bench_stop;
+#if START_USING_MUTEX
+static s_mutex             bench_mutex;
+static volatile s_uint32_t bench_t0;
+
+static void bench_mutex_high_entry(void)
+{
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_thread_sleep(1);
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        bench_record(s_cycle_get() - bench_t0);
+        s_mutex_release(&bench_mutex);
+    }
+    bench_stop = 1;
+    bench_worker_done();
+}
+
+/* Holds the mutex whenever the high thread wakes up and blocks on it. */
+static void bench_mutex_low_entry(void)
+{
+    while (!bench_stop)
+    {
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        while (!bench_stop && s_waitq_isempty(&bench_mutex.parent.suspend_thread))
+            ;
+        bench_t0 = s_cycle_get();
+        s_mutex_release(&bench_mutex);
+    }
+    bench_worker_done();
+}
+#endif
+
+/**
+ * @brief Rows: uncontended take + release, then contended hand over.
+ */
+void bench_mutex_paths(void)
+{
+#if START_USING_MUTEX
+    s_mutex_init(&bench_mutex, START_IPC_FLAG_PRIO);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        s_mutex_release(&bench_mutex);
+        bench_record(s_cycle_get() - t0);
+    }
+    bench_report("mutex uncontended");
+
+    bench_stop = 0;
+    bench_worker_start(0, bench_mutex_high_entry, BENCH_PRIO_HIGH);
+    bench_worker_start(1, bench_mutex_low_entry, BENCH_PRIO_LOW);
+    bench_worker_join(2);
+    bench_report("mutex contended");
+    s_mutex_delete(&bench_mutex);
+#endif
+}
+#if START_USING_MUTEX && START_USING_COND || START_USING_BARRIER
+static volatile s_uint32_t bench_woken;
+#endif
+
+#if START_USING_MUTEX && START_USING_RWLOCK
+static volatile s_uint32_t bench_sink;
+static s_uint32_t          bench_table[BENCH_TABLE_WORDS];
+static s_uint32_t          bench_readers;
+static s_pthread           bench_lead;
+static s_rwlock            bench_rwlock;
+static s_uint8_t           bench_use_rwlock;
+
+static void bench_reader_entry(void)
+{
+    s_uint8_t  lead = s_thread_get() == bench_lead;
+    s_uint8_t  armed = 0;
+    s_uint32_t t0 = 0;
+
+    while (!bench_stop)
+    {
+        s_uint32_t sum = 0;
+
+        if (bench_use_rwlock)
+            s_rwlock_take_read(&bench_rwlock, START_WAITING_FOREVER);
+        else
+            s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+
+        for (int i = 0; i < BENCH_TABLE_WORDS; i++)
+            sum += bench_table[i];
+        bench_sink = sum;
+        s_thread_yield();
+
+        if (bench_use_rwlock)
+            s_rwlock_release(&bench_rwlock);
+        else
+            s_mutex_release(&bench_mutex);
+
+        if (lead)
+        {
+            s_uint32_t t1 = s_cycle_get();
+            if (armed)
+                bench_record((t1 - t0) / bench_readers);
+            armed = 1;
+            t0    = t1;
+            if (bench_count() >= START_BENCH_SAMPLES)
+                bench_stop = 1;
+        }
+    }
+    bench_worker_done();
+}
+
+static void bench_readers_n(s_uint32_t n, s_uint8_t use_rwlock)
+{
+    bench_stop       = 0;
+    bench_readers    = n;
+    bench_use_rwlock = use_rwlock;
+
+    /* The controller outranks the readers: none runs before join. */
+    bench_lead = bench_worker_start(0, bench_reader_entry, BENCH_PRIO_READER);
+    for (s_uint32_t i = 1; i < n; i++)
+        bench_worker_start((int)i, bench_reader_entry, BENCH_PRIO_READER);
+    bench_worker_join((int)n);
+}
+#endif
+
+/**
+ * @brief Rows per reader count 1, 2, 4 ... 16: rwlock first, then mutex.
+ */
+void bench_rwlock_readers(void)
+{
+#if START_USING_MUTEX && START_USING_RWLOCK
+    s_mutex_init(&bench_mutex, START_IPC_FLAG_PRIO);
+    s_rwlock_init(&bench_rwlock, START_IPC_FLAG_PRIO, START_RWLOCK_PREFER_WRITER);
+    for (int i = 0; i < BENCH_TABLE_WORDS; i++)
+        bench_table[i] = (s_uint32_t)i * 2654435761u;
+
+    for (s_uint32_t n = 1; n <= BENCH_READERS_MAX && n <= BENCH_WORKER_MAX; n *= 2)
+    {
+        bench_readers_n(n, 1);
+        bench_report(bench_label("rwlock readers=", n));
+        bench_readers_n(n, 0);
+        bench_report(bench_label("mutex readers=", n));
+    }
+
+    s_rwlock_delete(&bench_rwlock);
+    s_mutex_delete(&bench_mutex);
+#endif
+}
+
+#if START_USING_MUTEX && START_USING_COND
+static s_cond              bench_cond;
+static s_sem               bench_sem;
+
+/* Today's pattern: a semaphore per event, then the mutex for the data. */
+static void bench_sem_mutex_entry(void)
+{
+    while (1)
+    {
+        s_sem_take(&bench_sem, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        bench_woken++;
+        s_mutex_release(&bench_mutex);
+    }
+    bench_worker_done();
+}
+
+static void bench_cond_entry(void)
+{
+    s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+    while (1)
+    {
+        s_cond_wait(&bench_cond, &bench_mutex, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+        bench_woken++;
+    }
+    s_mutex_release(&bench_mutex);
+    bench_worker_done();
+}
+
+static void bench_wake_n(s_uint32_t n, s_uint8_t use_cond)
+{
+    s_pthread self = s_thread_get();
+    s_uint8_t prio = BENCH_PRIO_WAITER + 1;
+
+    bench_stop = 0;
+    for (s_uint32_t i = 0; i < n; i++)
+        bench_worker_start((int)i, use_cond ? bench_cond_entry : bench_sem_mutex_entry,
+                           BENCH_PRIO_WAITER);
+
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+    s_sched_switch();   /* let every waiter run and park */
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+        if (use_cond)
+            s_cond_broadcast(&bench_cond);
+        else
+            for (s_uint32_t k = 0; k < n; k++)
+                s_sem_release(&bench_sem);
+        s_mutex_release(&bench_mutex);
+        bench_record(s_cycle_get() - t0);
+    }
+
+    bench_stop = 1;
+    s_mutex_take(&bench_mutex, START_WAITING_FOREVER);
+    if (use_cond)
+        s_cond_broadcast(&bench_cond);
+    else
+        for (s_uint32_t k = 0; k < n; k++)
+            s_sem_release(&bench_sem);
+    s_mutex_release(&bench_mutex);
+    prio = BENCH_PRIO_CTRL;
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+
+    bench_worker_join((int)n);
+}
+#endif
+
+/**
+ * @brief Rows per waiter count 1, 4, 16: broadcast first, then semaphores.
+ */
+void bench_cond_broadcast(void)
+{
+#if START_USING_MUTEX && START_USING_COND
+    s_mutex_init(&bench_mutex, START_IPC_FLAG_PRIO);
+    s_cond_init(&bench_cond, START_IPC_FLAG_PRIO);
+    s_sem_init(&bench_sem, 0, START_IPC_FLAG_PRIO);
+
+    for (s_uint32_t n = 1; n <= 16 && n <= BENCH_WORKER_MAX; n *= 4)
+    {
+        bench_wake_n(n, 1);
+        bench_report(bench_label("cond broadcast n=", n));
+        bench_wake_n(n, 0);
+        bench_report(bench_label("sem+mutex n=", n));
+    }
+
+    s_sem_delete(&bench_sem);
+    s_cond_delete(&bench_cond);
+    s_mutex_delete(&bench_mutex);
+#endif
+}
+
+#if START_USING_BARRIER
+static s_barrier bench_barrier;
+static s_sem     bench_go_sem;
+static s_sem     bench_done_sem;
+
+static void bench_barrier_entry(void)
+{
+    while (1)
+    {
+        s_barrier_wait(&bench_barrier, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+        bench_woken++;
+    }
+    bench_worker_done();
+}
+
+/* Today's pattern: one release per worker out, one per worker back. */
+static void bench_fanout_entry(void)
+{
+    while (1)
+    {
+        s_sem_take(&bench_go_sem, START_WAITING_FOREVER);
+        if (bench_stop)
+            break;
+        bench_woken++;
+        s_sem_release(&bench_done_sem);
+    }
+    bench_worker_done();
+}
+
+static void bench_phase_n(s_uint32_t n, s_uint8_t use_barrier)
+{
+    s_pthread self = s_thread_get();
+    s_uint8_t prio = BENCH_PRIO_WAITER + 1;
+
+    bench_stop = 0;
+    s_barrier_init(&bench_barrier, (s_uint16_t)(n + 1), START_IPC_FLAG_FIFO);
+    s_sem_init(&bench_go_sem, 0, START_IPC_FLAG_FIFO);
+    s_sem_init(&bench_done_sem, 0, START_IPC_FLAG_FIFO);
+    for (s_uint32_t i = 0; i < n; i++)
+        bench_worker_start((int)i, use_barrier ? bench_barrier_entry : bench_fanout_entry,
+                           BENCH_PRIO_WAITER);
+
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+    s_sched_switch();   /* let every worker run and park */
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t t0 = s_cycle_get();
+        if (use_barrier)
+        {
+            s_barrier_wait(&bench_barrier, START_WAITING_FOREVER);
+        }
+        else
+        {
+            for (s_uint32_t k = 0; k < n; k++)
+                s_sem_release(&bench_go_sem);
+            for (s_uint32_t k = 0; k < n; k++)
+                s_sem_take(&bench_done_sem, START_WAITING_FOREVER);
+        }
+        bench_record(s_cycle_get() - t0);
+    }
+
+    bench_stop = 1;
+    if (use_barrier)
+        s_barrier_wait(&bench_barrier, START_WAITING_FOREVER);
+    else
+        for (s_uint32_t k = 0; k < n; k++)
+            s_sem_release(&bench_go_sem);
+    prio = BENCH_PRIO_CTRL;
+    s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &prio);
+
+    bench_worker_join((int)n);
+    s_sem_delete(&bench_done_sem);
+    s_sem_delete(&bench_go_sem);
+    s_barrier_delete(&bench_barrier);
+}
+#endif
+
+/**
+ * @brief Rows per worker count 1, 4, 16: barrier first, then semaphores.
+ */
+void bench_barrier_phase(void)
+{
+#if START_USING_BARRIER
+    for (s_uint32_t n = 1; n <= 16 && n <= BENCH_WORKER_MAX; n *= 4)
+    {
+        bench_phase_n(n, 1);
+        bench_report(bench_label("barrier n=", n));
+        bench_phase_n(n, 0);
+        bench_report(bench_label("sem fan-out n=", n));
+    }
+#endif
+}
+
+#endif /* START_USING_BENCH */
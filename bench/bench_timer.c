@@ -0,0 +1,82 @@
+/**
+ * @file bench_timer.c
+ * @brief Software timer benchmarks: s_timer_start cost vs. armed timer count.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Timers are armed far in the future so none expires while measuring.
+ */
+
+#include "bench.h"
+
+#if START_USING_BENCH
+
+#define BENCH_TIMER_SPAN  1000000UL /**< Random timeout range (ticks) */
+
+static s_timer bench_timers[START_BENCH_TIMERS];
+static s_timer bench_probe;
+
+static s_uint32_t bench_seed = 0x12345678UL;
+
+/**
+ * @brief Small LCG so insert positions are spread over the list.
+ */
+static s_uint32_t bench_rand(void)
+{
+    bench_seed = bench_seed * 1103515245UL + 12345UL;
+    return bench_seed >> 8;
+}
+
+static void bench_timer_cb(void *p)
+{
+    (void)p;
+}
+
+static s_uint32_t bench_timer_timeout(void)
+{
+    return 100000UL + bench_rand() % BENCH_TIMER_SPAN;
+}
+
+/**
+ * @brief Sample s_timer_start() of one probe timer with n timers armed.
+ */
+static void bench_timer_insert_n(s_uint32_t n)
+{
+    for (s_uint32_t i = 0; i < n; i++)
+    {
+        s_timer_init(&bench_timers[i], bench_timer_cb, NULL, bench_timer_timeout());
+        s_timer_start(&bench_timers[i]);
+    }
+
+    s_timer_init(&bench_probe, bench_timer_cb, NULL, 0);
+    for (int i = 0; i < START_BENCH_SAMPLES; i++)
+    {
+        s_uint32_t tick = bench_timer_timeout();
+        s_timer_ctrl(&bench_probe, START_TIMER_SET_TIME, &tick);
+
+        s_uint32_t t0 = s_cycle_get();
+        s_timer_start(&bench_probe);
+        bench_record(s_cycle_get() - t0);
+
+        s_timer_stop(&bench_probe);
+    }
+
+    for (s_uint32_t i = 0; i < n; i++)
+        s_timer_stop(&bench_timers[i]);
+}
+
+/**
+ * @brief One row per population size: 4, 16, 64, ... START_BENCH_TIMERS.
+ */
+void bench_timer_insert(void)
+{
+    for (s_uint32_t n = 4; n <= START_BENCH_TIMERS; n *= 4)
+    {
+        bench_timer_insert_n(n);
+        bench_report(bench_label("timer start n=", n));
+    }
+}
+
+#endif /* START_USING_BENCH */
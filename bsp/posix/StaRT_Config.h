@@ -0,0 +1,69 @@
+
+
+#ifndef __SCONFIG_H_
+#define __SCONFIG_H_
+
+/*1:开启资源，0:关闭资源*/
+
+#define START_VERSION "1.0.2"
+
+#define START_THREAD_PRIORITY_MAX      256  // >32 时使用两级就绪位图
+#define START_USING_CPU_FFS            1
+#define START_TIMER_SKIP_LIST_LEVEL    4
+#define START_TIMER_SKIP_LIST_MASK     3    // 每 (MASK+1) 个定时器提升一层
+#define START_TIMER_WHEEL              0    // 1:使用分层时间轮替代跳表
+#define START_TIMER_WHEEL_BITS         6    // 每层槽位数 = 2^BITS
+#define START_TIMER_WHEEL_LEVELS       4    // 时间轮层数 (BITS*LEVELS <= 31)
+#define START_TICK                     1000 // 每秒1000个tick
+#define START_USING_TICKLESS           1    // 1:空闲时停止 SysTick 直到下一个定时器到期
+#define START_TICKLESS_MIN_TICKS       2    // 少于该 tick 数不进入 tickless
+#define START_TICKLESS_MAX_TICKS       0xFFFF // 单次最多抑制的 tick 数 (真实时钟下移植层另限 4 s, 低于 s_cycle_get 回绕)
+#define START_USING_RUNTIME_STATS      1    // 1:统计线程运行时间与 CPU 负载
+#define START_USING_TRACE              1    // 1:记录内核事件到 RAM 环形缓冲区
+#define START_TRACE_EVENTS             4096 // 事件槽位数 (2 的幂，每个 16 字节)
+#define START_TRACE_CLOCK_HZ           1000000000 // 时间戳频率 (CLOCK_MONOTONIC 纳秒)
+
+#define S_PRINTF_BUF_SIZE              128  // 定义缓冲区大小
+
+#define START_IDLE_STACK_SIZE          16384 // 主机信号处理在线程栈上运行，需要较大栈
+
+#define START_USING_THREAD_NOTIFY       1    // 线程通知 (线程内置通知值, 单接收者轻量信号量)
+
+#define START_USING_MUTEX               1
+#define START_MUTEX_FAST_PATH           1    // 无竞争时互斥量以 CAS 获取/释放, 不关中断 (需 LDREX/STREX 或主机原子操作)
+#define START_USING_RWLOCK              1    // 读写锁 (多读者并发, 写者独占, 可选写者优先)
+#define START_USING_COND                1    // 条件变量 (配合互斥量使用)
+#define START_USING_SEMAPHORE           1
+#define START_USING_MESSAGEQUEUE        1
+#define START_USING_VMSGQUEUE           1    // 变长消息队列 (长度前缀记录紧凑排列)
+#define START_USING_PRIOQUEUE           1    // 优先级消息队列 (每优先级子链表 + 位图, O(1) 收发)
+#define START_PRIOQ_LEVELS              8    // 消息优先级数 (1..32, 0 最高)
+#define START_USING_MAILBOX             1    // 邮箱 (32 位槽位环形数组)
+#define START_USING_RINGBUF             1    // 无锁单生产者/单消费者环形缓冲区
+#define START_USING_STREAM              1    // 字节流 (连续缓冲区, 无消息头, 接收触发水位)
+#define START_USING_EVENT               1    // 事件标志组 (AND/OR/CLEAR)
+#define START_USING_BARRIER             1    // 线程屏障 (分阶段并行计算同步)
+#define START_USING_WAITSET             1    // 等待集合 (同时阻塞等待多个信号量/消息队列)
+#define START_WAITSET_MAX               8    // 每个等待集合最多成员数
+
+#define START_DEBUG                     1
+#define START_USING_IPC                 1
+#define START_IPC_WAIT_POOL             16   // 可借用按优先级链表头的 PRIO 等待队列数 (0..32), 256 个优先级用两级位图, 入队出队 O(1); 用尽时 init 返回 S_ERR
+
+/* bench/ 基准测试 */
+#define START_USING_BENCH               1    // 编译 bench/ (仅 start-bench 链接)
+#define START_BENCH_SAMPLES             1024  // 每个测试用例采样数
+#define START_BENCH_STACK_SIZE          16384  // 基准测试线程栈大小
+#define START_BENCH_TIMERS              1024  // 定时器插入测试的最大定时器数量
+#define START_BENCH_WORKERS             64   // 基准测试工作线程数量 (>= 4)
+#define START_BENCH_UNIT                "ns"   // 主机端使用 CLOCK_MONOTONIC 纳秒
+#define START_BENCH_BATCH               16   // 接近计数器读取开销的用例每个样本连续执行的次数
+#define START_BENCH_CLOCK_MHZ           1000   // 计数器频率 (纳秒 = 1000 MHz)
+
+
+
+
+
+
+
+#endif
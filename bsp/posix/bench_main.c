@@ -0,0 +1,27 @@
+/**
+ * @file bench_main.c
+ * @brief POSIX host BSP entry for the kernel benchmark suite (bench/).
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+
+/**
+ * @brief Leave the process once the table has been printed.
+ */
+void bench_finish(void)
+{
+    exit(0);
+}
+
+int main(void)
+{
+    s_start_init();
+    bench_init();
+    s_sched_start(); /* never returns */
+    return 0;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file console.c
+ * @brief POSIX host BSP console: s_putc over write(2).
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ */
+
+#include "start.h"
+#include <unistd.h>
+
+/**
+ * @brief Console output through write(2) (stdio is not reentrant across threads).
+ */
+void s_putc(char c)
+{
+    (void)write(STDOUT_FILENO, &c, 1);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file main.c
+ * @brief POSIX host BSP demo: mutex priority inheritance as on the STM32 board.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Runs for START_DEMO_SECONDS and exits so it can be used on a build server.
+ *   With START_USING_TRACE, "start-posix trace.bin" saves the trace buffer on
+ *   exit for tools/trace2chrome.py.
+ */
+
+#include "start.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define THREAD_STACK_SIZE  16384
+#define START_DEMO_SECONDS 3
+
+static s_mutex mutex1;
+
+static s_thread thread1;
+static s_thread thread2;
+static s_thread thread3;
+
+static s_uint8_t thread1stack[THREAD_STACK_SIZE];
+static s_uint8_t thread2stack[THREAD_STACK_SIZE];
+static s_uint8_t thread3stack[THREAD_STACK_SIZE];
+
+#if START_USING_TRACE
+static const char *demo_trace_file;
+
+/**
+ * @brief Write the raw trace buffer (same bytes a debugger dump would give).
+ */
+static void demo_save_trace(void)
+{
+    FILE *f;
+
+    if (demo_trace_file == NULL)
+        return;
+    s_trace_stop();
+    f = fopen(demo_trace_file, "wb");
+    if (f == NULL)
+        return;
+    fwrite(&s_trace_buf, sizeof(s_trace_buf), 1, f);
+    fclose(f);
+}
+#endif
+
+#if START_USING_RUNTIME_STATS
+/**
+ * @brief Print per-thread CPU time (microseconds) and overall load.
+ */
+static void demo_print_stats(void)
+{
+    s_thread_stat st[8];
+    s_uint64_t    total;
+    s_uint32_t    n = s_thread_stats_snapshot(st, 8, &total);
+
+    s_printf("prio  status  runtime(us)  share(permille)\n");
+    for (s_uint32_t i = 0; i < n && i < 8; i++)
+    {
+        s_printf("%d  %d  %d  %d\n",
+                 (int)st[i].current_priority, (int)st[i].status,
+                 (int)(st[i].runtime / 1000),
+                 total ? (int)(st[i].runtime * 1000 / total) : 0);
+    }
+    s_printf("cpu load: %d permille\n", (int)s_system_load_get());
+}
+#endif
+
+static void thread1entry(void) /* High priority (waits for mutex) */
+{
+    s_mdelay(100); /* Let the low priority thread take the mutex first */
+    s_printf("HIGH : try take mutex\n");
+    if (S_OK == s_mutex_take(&mutex1, START_WAITING_FOREVER))
+    {
+        s_printf("HIGH : got mutex (after inheritance)\n");
+        s_mutex_release(&mutex1);
+        s_printf("HIGH : released mutex\n");
+    }
+
+    while (1)
+    {
+        if (s_tick_get() >= START_DEMO_SECONDS * START_TICK)
+        {
+            s_printf("demo finished at tick %d\n", (int)s_tick_get());
+#if START_USING_RUNTIME_STATS
+            demo_print_stats();
+#endif
+#if START_USING_TRACE
+            demo_save_trace();
+#endif
+            exit(0);
+        }
+        s_mdelay(50);
+    }
+}
+
+static void thread2entry(void) /* Medium priority (CPU interference) */
+{
+    int i = 0;
+    while (1)
+    {
+        if (++i % 10 == 0)
+            s_printf("MED  : running i=%d\n", i);
+        s_mdelay(40);
+    }
+}
+
+static void thread3entry(void) /* Low priority (holds mutex for a long time) */
+{
+    s_uint8_t base_prio_saved;
+
+    if (S_OK == s_mutex_take(&mutex1, START_WAITING_FOREVER))
+    {
+        base_prio_saved = s_thread_get()->current_priority;
+        s_printf("LOW  : took mutex, do long work (base prio=%d)\n", base_prio_saved);
+
+        for (int seg = 0; seg < 5; seg++)
+        {
+            s_mdelay(120);
+            if (s_thread_get()->current_priority != base_prio_saved)
+                s_printf("LOW  : inherited priority -> %d (seg=%d)\n",
+                         s_thread_get()->current_priority, seg);
+        }
+
+        s_printf("LOW  : releasing mutex\n");
+        s_mutex_release(&mutex1);
+        s_printf("LOW  : released mutex (prio=%d)\n", s_thread_get()->current_priority);
+    }
+
+    while (1)
+    {
+        if (S_OK == s_mutex_take(&mutex1, START_WAITING_FOREVER))
+        {
+            s_mdelay(30);
+            s_mutex_release(&mutex1);
+        }
+        s_mdelay(200);
+    }
+}
+
+int main(int argc, char **argv)
+{
+#if START_USING_TRACE
+    if (argc > 1)
+        demo_trace_file = argv[1];
+#else
+    (void)argc;
+    (void)argv;
+#endif
+    s_start_init();
+
+    s_mutex_init(&mutex1, START_IPC_FLAG_FIFO);
+
+    s_thread_init(&thread1, thread1entry, thread1stack, THREAD_STACK_SIZE, 10, 10);
+    s_thread_startup(&thread1);
+    s_thread_init(&thread2, thread2entry, thread2stack, THREAD_STACK_SIZE, 12, 10);
+    s_thread_startup(&thread2);
+    s_thread_init(&thread3, thread3entry, thread3stack, THREAD_STACK_SIZE, 15, 10);
+    s_thread_startup(&thread3);
+
+    s_sched_start(); /* never returns */
+    return 0;
+}
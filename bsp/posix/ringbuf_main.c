@@ -0,0 +1,208 @@
+/**
+ * @file ringbuf_main.c
+ * @brief POSIX host BSP: s_ringbuf producer / consumer stress check.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Phase 1 streams bytes from the tick interrupt (a timer callback writes a
+ *   random burst every tick) into a consumer thread that reads random chunk
+ *   sizes and busy-waits at random, so SIGALRM lands inside s_ringbuf_read()
+ *   and the ring regularly runs full. Phase 2 streams 8-byte elements from a
+ *   lower priority producer thread, so every trigger crossing preempts it.
+ *   Every element carries a sequence number; any loss, duplicate or
+ *   reordering is reported and the run fails.
+ */
+
+#include "start.h"
+#include <stdlib.h>
+
+#define THREAD_STACK_SIZE  16384
+
+#define ISR_RING_SIZE      256
+#define ISR_TRIGGER        32
+#define ISR_TICKS          3000
+
+#define THR_RING_SIZE      64
+#define THR_TRIGGER        16
+#define THR_ELEMENTS       200000
+
+struct elem
+{
+    s_uint32_t seq;
+    s_uint32_t inv;
+};
+
+static s_ringbuf   isr_rb;
+static s_uint8_t   isr_ring[ISR_RING_SIZE];
+static s_timer     isr_timer;
+static s_uint32_t  isr_seq;
+static s_uint32_t  isr_ticks;
+static s_uint32_t  isr_dropped;
+static volatile s_uint8_t isr_done;
+
+static s_ringbuf   thr_rb;
+static struct elem thr_ring[THR_RING_SIZE];
+
+static s_thread    consumer;
+static s_thread    producer;
+static s_uint8_t   consumer_stack[THREAD_STACK_SIZE];
+static s_uint8_t   producer_stack[THREAD_STACK_SIZE];
+
+static s_uint32_t  errors;
+
+/**
+ * @brief Small LCG (one instance per context, no locking).
+ */
+static s_uint32_t rnd(s_uint32_t *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Tick interrupt producer: one burst of 1..97 sequential bytes.
+ */
+static void isr_produce(void *p)
+{
+    static s_uint32_t state = 1;
+    s_uint8_t  burst[97];
+    s_uint32_t n = rnd(&state) % 97 + 1;
+    s_uint32_t done;
+
+    (void)p;
+    for (s_uint32_t i = 0; i < n; i++)
+        burst[i] = (s_uint8_t)(isr_seq + i);
+
+    /* Bytes that do not fit are dropped, the sequence continues after the rest. */
+    done = s_ringbuf_write(&isr_rb, burst, n);
+    isr_seq     += done;
+    isr_dropped += n - done;
+
+    if (++isr_ticks < ISR_TICKS)
+        s_timer_start(&isr_timer);
+    else
+        isr_done = 1;
+}
+
+static void consume_bytes(void)
+{
+    s_uint32_t state = 7;
+    s_uint8_t  chunk[128];
+    s_uint32_t expect = 0;
+    s_uint32_t reads  = 0;
+
+    s_timer_init(&isr_timer, isr_produce, NULL, 1);
+    s_timer_start(&isr_timer);
+
+    while (!isr_done || s_ringbuf_count(&isr_rb))
+    {
+        s_uint32_t n = s_ringbuf_read(&isr_rb, chunk, rnd(&state) % 128 + 1, 3);
+
+        for (s_uint32_t i = 0; i < n; i++, expect++)
+        {
+            if (chunk[i] != (s_uint8_t)expect)
+            {
+                s_printf("isr: byte %d is %d, expected %d\n",
+                         (int)expect, chunk[i], (int)(s_uint8_t)expect);
+                errors++;
+                expect = chunk[i];
+            }
+        }
+        reads++;
+
+        /* Random busy time; now and then stall for ms so the ring runs full. */
+        s_uint32_t r = rnd(&state);
+        for (volatile s_uint32_t spin = (r % 64 == 0) ? 2000000 : r % 4 * 5000; spin; spin--)
+            ;
+    }
+
+    if (expect != isr_seq)
+    {
+        s_printf("isr: received %d bytes, produced %d\n", (int)expect, (int)isr_seq);
+        errors++;
+    }
+    s_printf("isr -> thread: %d bytes in %d reads, %d dropped on full ring\n",
+             (int)expect, (int)reads, (int)isr_dropped);
+}
+
+static void producer_entry(void)
+{
+    s_uint32_t  state = 3;
+    struct elem chunk[20];
+    s_uint32_t  seq = 0;
+
+    while (seq < THR_ELEMENTS)
+    {
+        s_uint32_t n = rnd(&state) % 20 + 1;
+        if (n > THR_ELEMENTS - seq)
+            n = THR_ELEMENTS - seq;
+        for (s_uint32_t i = 0; i < n; i++)
+        {
+            chunk[i].seq = seq + i;
+            chunk[i].inv = ~(seq + i);
+        }
+
+        s_uint32_t done = s_ringbuf_write(&thr_rb, chunk, n);
+        seq += done;
+        if (done < n)
+            s_thread_yield();
+    }
+}
+
+static void consume_elements(void)
+{
+    struct elem chunk[THR_RING_SIZE];
+    s_uint32_t  expect = 0;
+    s_uint32_t  reads  = 0;
+    s_uint32_t  t0     = s_cycle_get();
+    s_uint32_t  ns;
+
+    s_thread_init(&producer, producer_entry, producer_stack, THREAD_STACK_SIZE, 6, 10);
+    s_thread_startup(&producer);
+
+    while (expect < THR_ELEMENTS)
+    {
+        s_uint32_t n = s_ringbuf_read(&thr_rb, chunk, THR_RING_SIZE, 5);
+
+        for (s_uint32_t i = 0; i < n; i++, expect++)
+        {
+            if (chunk[i].seq != expect || chunk[i].inv != ~expect)
+            {
+                s_printf("thread: element %d is %d\n", (int)expect, (int)chunk[i].seq);
+                errors++;
+                expect = chunk[i].seq;
+            }
+        }
+        reads++;
+    }
+    ns = s_cycle_get() - t0;
+
+    s_printf("thread -> thread: %d elements in %d reads (trigger %d), %d MB/s\n",
+             (int)expect, (int)reads, THR_TRIGGER,
+             (int)((s_uint64_t)expect * sizeof(struct elem) * 1000 / (ns ? ns : 1)));
+}
+
+static void consumer_entry(void)
+{
+    consume_bytes();
+    consume_elements();
+
+    s_printf(errors == 0 ? "PASS\n" : "FAIL\n");
+    exit(errors == 0 ? 0 : 1);
+}
+
+int main(void)
+{
+    s_start_init();
+
+    s_ringbuf_init(&isr_rb, isr_ring, 1, ISR_RING_SIZE, ISR_TRIGGER);
+    s_ringbuf_init(&thr_rb, thr_ring, sizeof(struct elem), THR_RING_SIZE, THR_TRIGGER);
+
+    s_thread_init(&consumer, consumer_entry, consumer_stack, THREAD_STACK_SIZE, 5, 10);
+    s_thread_startup(&consumer);
+
+    s_sched_start(); /* never returns */
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file tickless_main.c
+ * @brief POSIX host BSP: tickless idle check on a virtual clock.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Threads sleep for co-prime periods and verify that they wake on the exact
+ *   expected tick. With the virtual clock the idle fast-forwards, so about
+ *   one tick interrupt per wakeup is delivered instead of one per tick.
+ *   Before that, s_tickless_split() (the early-wake arithmetic of the CM3
+ *   port, which the virtual clock never exercises) is checked against a
+ *   brute-force walk of the tick grid.
+ */
+
+#include "start.h"
+#include <stdlib.h>
+
+#define THREAD_STACK_SIZE  16384
+#define TICKLESS_ROUNDS    40
+
+/* POSIX port diagnostics (libcpu/posix/cpuport.c) */
+extern volatile s_uint32_t s_posix_tick_count;
+extern volatile int        s_posix_virtual_clock;
+
+static s_thread  sleeper[3];
+static s_uint8_t sleeper_stack[3][THREAD_STACK_SIZE];
+static const s_uint32_t sleeper_period[3] = { 7, 130, 1009 };
+static volatile int sleeper_errors;
+static volatile int sleeper_left = 3;
+
+static void sleeper_run(int id)
+{
+    for (int i = 0; i < TICKLESS_ROUNDS; i++)
+    {
+        s_uint32_t before = s_tick_get();
+        s_thread_sleep(sleeper_period[id]);
+        s_uint32_t slept = s_tick_get() - before;
+        /* A tick may land between reading s_tick and arming the timer. */
+        if (slept < sleeper_period[id] || slept > sleeper_period[id] + 1)
+        {
+            s_printf("sleeper %d: slept %d ticks, expected %d\n",
+                     id, (int)slept, (int)sleeper_period[id]);
+            sleeper_errors++;
+        }
+    }
+
+    if (--sleeper_left == 0)
+    {
+        s_printf("tickless: s_tick=%d tick irqs=%d errors=%d\n",
+                 (int)s_tick_get(), (int)s_posix_tick_count, sleeper_errors);
+        s_printf(sleeper_errors == 0 ? "PASS\n" : "FAIL\n");
+        exit(sleeper_errors == 0 ? 0 : 1);
+    }
+}
+
+/**
+ * @brief Check one early wakeup: into cycles of the running tick were gone
+ *        when the sleep began, elapsed cycles counted since.
+ * @return 1 on mismatch.
+ */
+static int split_check(s_uint32_t cpt, s_uint32_t into, s_uint32_t elapsed)
+{
+    s_uint32_t now = into + elapsed;
+    s_uint32_t crossed = 0;
+    s_uint32_t next = cpt;
+    s_uint32_t reload;
+    s_uint32_t got = s_tickless_split(cpt, into, elapsed, &reload);
+
+    /* Walk the grid: boundaries at k * cpt since the last tick before sleep. */
+    while (next <= now)
+    {
+        crossed++;
+        next += cpt;
+    }
+    /* Next IRQ on a boundary, never a 0 reload, every boundary before it
+     * counted (one cycle early at most when the boundary is 1 cycle away). */
+    if ((now + reload + 1) % cpt == 0 && reload >= 1 &&
+        got == (now + reload + 1) / cpt - 1 &&
+        (got == crossed || (got == crossed + 1 && next - now == 1)))
+        return 0;
+
+    s_printf("split cpt=%d into=%d elapsed=%d: got %d reload %d, expected %d\n",
+             (int)cpt, (int)into, (int)elapsed, (int)got, (int)reload, (int)crossed);
+    return 1;
+}
+
+/**
+ * @brief Exhaustive on small grids, sampled on a 72 MHz / 1 kHz SysTick.
+ */
+static void split_run(void)
+{
+    static const s_uint32_t small[] = { 1, 2, 3, 7, 10 };
+    s_uint32_t cases = 0;
+    int errors = 0;
+
+    for (unsigned i = 0; i < sizeof(small) / sizeof(small[0]); i++)
+    {
+        for (s_uint32_t into = 1; into <= small[i]; into++)
+        {
+            for (s_uint32_t elapsed = 0; elapsed < 4 * small[i]; elapsed++, cases++)
+                errors += split_check(small[i], into, elapsed);
+        }
+    }
+    for (s_uint32_t into = 1; into <= 72000; into += 997)
+    {
+        for (s_uint32_t elapsed = 0; elapsed < 5 * 72000; elapsed += 331, cases++)
+            errors += split_check(72000, into, elapsed);
+    }
+
+    /* Woken 10 cycles past the first boundary: one tick done, phase kept. */
+    s_uint32_t reload;
+    if (s_tickless_split(72000, 72000 - 50000, 50000 + 10, &reload) != 1 ||
+        reload != 72000 - 10 - 1)
+        errors++;
+
+    s_printf("tickless split: %d cases, errors=%d\n", (int)cases, errors);
+    sleeper_errors += errors;
+}
+
+static void sleeper0_entry(void) { sleeper_run(0); }
+static void sleeper1_entry(void) { sleeper_run(1); }
+static void sleeper2_entry(void) { sleeper_run(2); }
+
+int main(void)
+{
+    static void (*const entry[3])(void) = { sleeper0_entry, sleeper1_entry, sleeper2_entry };
+
+    s_posix_virtual_clock = 1;
+    s_start_init();
+    split_run();
+
+    for (int i = 0; i < 3; i++)
+    {
+        s_thread_init(&sleeper[i], entry[i], sleeper_stack[i], THREAD_STACK_SIZE, 10 + i, 10);
+        s_thread_startup(&sleeper[i]);
+    }
+
+    s_sched_start(); /* never returns */
+    return 0;
+}
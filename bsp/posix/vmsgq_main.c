@@ -0,0 +1,208 @@
+/**
+ * @file vmsgq_main.c
+ * @brief POSIX host BSP: variable-length message queue memory comparison
+ *        and producer / consumer check.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   First fills an s_msgqueue and an s_vmsgqueue sharing the same pool budget
+ *   with several message size mixes and prints how many messages each holds.
+ *   Then two producer threads send random 3..200 byte messages through a
+ *   small s_vmsgqueue to one consumer, which checks every length, payload
+ *   byte and per-producer sequence number.
+ */
+
+#include "start.h"
+#include <stdlib.h>
+
+#define THREAD_STACK_SIZE  16384
+
+#define POOL_BYTES         2048
+#define MSG_MAX            200
+
+#define STRESS_POOL        512
+#define STRESS_MSGS        50000
+#define PRODUCERS          2
+
+static s_uint8_t    pool[POOL_BYTES];
+static s_uint8_t    msg[MSG_MAX];
+
+static s_msgqueue   mq;
+static s_vmsgqueue  vq;
+static s_vmsgqueue  stress_vq;
+static s_uint8_t    stress_pool[STRESS_POOL];
+
+static s_thread     consumer;
+static s_thread     producers[PRODUCERS];
+static s_uint8_t    consumer_stack[THREAD_STACK_SIZE];
+static s_uint8_t    producer_stacks[PRODUCERS][THREAD_STACK_SIZE];
+
+static s_uint32_t   errors;
+
+/**
+ * @brief Small LCG (one instance per context, no locking).
+ */
+static s_uint32_t rnd(s_uint32_t *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+/* Message size mixes: next size for a given random value. */
+static s_uint16_t mix_commands(s_uint32_t r) { (void)r; return 8; }
+static s_uint16_t mix_rare_blobs(s_uint32_t r) { return (r % 20 == 0) ? MSG_MAX : 8; }
+static s_uint16_t mix_uniform(s_uint32_t r) { return (s_uint16_t)(r % MSG_MAX + 1); }
+static s_uint16_t mix_blobs(s_uint32_t r) { (void)r; return MSG_MAX; }
+
+static const struct
+{
+    const char *name;
+    s_uint16_t (*size)(s_uint32_t r);
+} mixes[] =
+{
+    { "8 B commands        ", mix_commands   },
+    { "95% 8 B + 5% 200 B  ", mix_rare_blobs },
+    { "uniform 1..200 B    ", mix_uniform    },
+    { "200 B blobs         ", mix_blobs      },
+};
+
+/**
+ * @brief Fill both queue kinds with one size mix until the next send fails.
+ */
+static void compare_mix(int m)
+{
+    s_uint32_t state = 11;
+    s_uint32_t mq_msgs = 0, mq_bytes = 0;
+    s_uint32_t vq_msgs = 0, vq_bytes = 0;
+
+    /* Fixed slots must be sized for the longest message of every mix. */
+    s_msgqueue_init(&mq, pool, MSG_MAX, POOL_BYTES, START_IPC_FLAG_FIFO);
+    for (;;)
+    {
+        s_uint16_t n = mixes[m].size(rnd(&state));
+        if (s_msgqueue_send(&mq, msg, n) != S_OK)
+            break;
+        mq_msgs++;
+        mq_bytes += n;
+    }
+    s_msgqueue_delete(&mq);
+
+    state = 11;
+    s_vmsgqueue_init(&vq, pool, POOL_BYTES, START_IPC_FLAG_FIFO);
+    for (;;)
+    {
+        s_uint16_t n = mixes[m].size(rnd(&state));
+        if (s_vmsgqueue_send(&vq, msg, n) != S_OK)
+            break;
+        vq_msgs++;
+        vq_bytes += n;
+    }
+    s_vmsgqueue_delete(&vq);
+
+    s_printf("%s %d msgs / %d B     %d msgs / %d B\n", mixes[m].name,
+             (int)mq_msgs, (int)mq_bytes, (int)vq_msgs, (int)vq_bytes);
+}
+
+static void producer_entry(void)
+{
+    s_uint8_t  id    = (s_uint8_t)(s_thread_get() - producers);
+    s_uint32_t state = 100 + id;
+    s_uint8_t  buf[MSG_MAX];
+
+    for (s_uint32_t seq = 0; seq < STRESS_MSGS; seq++)
+    {
+        s_uint16_t n = (s_uint16_t)(rnd(&state) % (MSG_MAX - 2) + 3);
+
+        buf[0] = id;
+        buf[1] = (s_uint8_t)seq;
+        buf[2] = (s_uint8_t)(seq >> 8);
+        for (s_uint16_t i = 3; i < n; i++)
+            buf[i] = (s_uint8_t)(seq * 7 + i);
+
+        if (s_vmsgqueue_send_wait(&stress_vq, buf, n, START_WAITING_FOREVER) != S_OK)
+            errors++;
+    }
+}
+
+static void consumer_entry(void)
+{
+    s_uint32_t expect[PRODUCERS] = { 0 };
+    s_uint8_t  buf[MSG_MAX];
+    s_uint8_t  small[8];
+    s_uint16_t len;
+    s_uint32_t total = 0;
+
+    s_printf("\nmix (%d-byte pool)      s_msgqueue       s_vmsgqueue\n", POOL_BYTES);
+    for (unsigned m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++)
+        compare_mix((int)m);
+    s_printf("(messages held at once / payload bytes they carry)\n\n");
+
+    s_vmsgqueue_init(&stress_vq, stress_pool, sizeof(stress_pool), START_IPC_FLAG_FIFO);
+
+    /* Empty queue: timeout. Too small a buffer: length reported, message kept. */
+    if (s_vmsgqueue_recv(&stress_vq, buf, sizeof(buf), &len, 2) != S_TIMEOUT)
+        errors++;
+    s_vmsgqueue_send(&stress_vq, msg, 20);
+    if (s_vmsgqueue_recv(&stress_vq, small, sizeof(small), &len, 0) != S_INVALID || len != 20)
+        errors++;
+    if (s_vmsgqueue_recv(&stress_vq, buf, sizeof(buf), &len, 0) != S_OK || len != 20)
+        errors++;
+    if (s_vmsgqueue_send(&stress_vq, msg, STRESS_POOL) != S_INVALID)
+        errors++;
+
+    for (int i = 0; i < PRODUCERS; i++)
+    {
+        s_thread_init(&producers[i], producer_entry, producer_stacks[i],
+                      THREAD_STACK_SIZE, (s_uint8_t)(4 + 2 * i), 10);
+        s_thread_startup(&producers[i]);
+    }
+
+    while (total < PRODUCERS * STRESS_MSGS)
+    {
+        if (s_vmsgqueue_recv(&stress_vq, buf, sizeof(buf), &len, 50) != S_OK)
+        {
+            s_printf("recv timed out after %d messages\n", (int)total);
+            errors++;
+            break;
+        }
+
+        s_uint8_t  id  = buf[0];
+        s_uint32_t seq = buf[1] | ((s_uint32_t)buf[2] << 8);
+        if (len < 3 || id >= PRODUCERS || seq != (expect[id] & 0xFFFF))
+        {
+            s_printf("bad header: len %d id %d seq %d\n", len, id, (int)seq);
+            errors++;
+            break;
+        }
+        for (s_uint16_t i = 3; i < len; i++)
+        {
+            if (buf[i] != (s_uint8_t)(expect[id] * 7 + i))
+            {
+                s_printf("bad payload: id %d seq %d byte %d\n", id, (int)seq, i);
+                errors++;
+                break;
+            }
+        }
+        expect[id]++;
+        total++;
+    }
+
+    s_printf("%d producers -> 1 consumer: %d messages through a %d-byte pool\n",
+             PRODUCERS, (int)total, STRESS_POOL);
+    s_printf(errors == 0 ? "PASS\n" : "FAIL\n");
+    exit(errors == 0 ? 0 : 1);
+}
+
+int main(void)
+{
+    s_start_init();
+
+    /* Consumer between the two producers: one preempts it, one does not. */
+    s_thread_init(&consumer, consumer_entry, consumer_stack, THREAD_STACK_SIZE, 5, 10);
+    s_thread_startup(&consumer);
+
+    s_sched_start(); /* never returns */
+    return 0;
+}
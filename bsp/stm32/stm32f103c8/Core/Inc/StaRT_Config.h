@@ -8,18 +8,55 @@
 #define START_THREAD_PRIORITY_MAX      32
 #define START_USING_CPU_FFS            1
 #define START_TIMER_SKIP_LIST_LEVEL    1
+#define START_TIMER_SKIP_LIST_MASK     3    // 每 (MASK+1) 个定时器提升一层
+#define START_TIMER_WHEEL              0    // 1:使用分层时间轮替代跳表
+#define START_TIMER_WHEEL_BITS         6    // 每层槽位数 = 2^BITS
+#define START_TIMER_WHEEL_LEVELS       4    // 时间轮层数 (BITS*LEVELS <= 31)
 #define START_TICK                     1000 // 每秒1000个tick
+#define START_USING_TICKLESS           0    // 1:空闲时停止 SysTick 直到下一个定时器到期
+#define START_TICKLESS_MIN_TICKS       2    // 少于该 tick 数不进入 tickless
+#define START_TICKLESS_MAX_TICKS       0xFFFF // 单次最多抑制的 tick 数
+#define START_USING_RUNTIME_STATS      0    // 1:统计线程运行时间与 CPU 负载
+#define START_USING_TRACE              0    // 1:记录内核事件到 RAM 环形缓冲区
+#define START_TRACE_EVENTS             256  // 事件槽位数 (2 的幂，每个 16 字节)
+#define START_TRACE_CLOCK_HZ           72000000 // 时间戳频率 (DWT CYCCNT = HCLK)
 
 #define S_PRINTF_BUF_SIZE              128  // 定义缓冲区大小
 
 #define START_IDLE_STACK_SIZE          256  // 定义空闲线程栈大小
 
+#define START_USING_THREAD_NOTIFY       1    // 线程通知 (线程内置通知值, 单接收者轻量信号量)
+
 #define START_USING_MUTEX               1
+#define START_MUTEX_FAST_PATH           1    // 无竞争时互斥量以 CAS 获取/释放, 不关中断 (需 LDREX/STREX 或主机原子操作)
+#define START_USING_RWLOCK              1    // 读写锁 (多读者并发, 写者独占, 可选写者优先)
+#define START_USING_COND                1    // 条件变量 (配合互斥量使用)
 #define START_USING_SEMAPHORE           1
 #define START_USING_MESSAGEQUEUE        1
+#define START_USING_VMSGQUEUE           1    // 变长消息队列 (长度前缀记录紧凑排列)
+#define START_USING_PRIOQUEUE           1    // 优先级消息队列 (每优先级子链表 + 位图, O(1) 收发)
+#define START_PRIOQ_LEVELS              8    // 消息优先级数 (1..32, 0 最高)
+#define START_USING_MAILBOX             1    // 邮箱 (32 位槽位环形数组)
+#define START_USING_RINGBUF             1    // 无锁单生产者/单消费者环形缓冲区
+#define START_USING_STREAM              1    // 字节流 (连续缓冲区, 无消息头, 接收触发水位)
+#define START_USING_EVENT               1    // 事件标志组 (AND/OR/CLEAR)
+#define START_USING_BARRIER             1    // 线程屏障 (分阶段并行计算同步)
+#define START_USING_WAITSET             1    // 等待集合 (同时阻塞等待多个信号量/消息队列)
+#define START_WAITSET_MAX               8    // 每个等待集合最多成员数
 
 #define START_DEBUG                     1
 #define START_USING_IPC                 1
+#define START_IPC_WAIT_POOL             4    // 可借用按优先级链表头的 PRIO 等待队列数 (0..32), 每份 8 + 优先级数 x 8 字节, 入队出队 O(1); 用尽时 init 返回 S_ERR; 0 = PRIO 队列用有序单链表
+
+/* bench/ 基准测试 */
+#define START_USING_BENCH               0    // 1:编译 bench/ 并由 main 启动基准测试 (替代演示线程, 结果经 USART1 输出)
+#define START_BENCH_SAMPLES             256  // 每个测试用例采样数
+#define START_BENCH_STACK_SIZE          512  // 基准测试线程栈大小
+#define START_BENCH_TIMERS              64  // 定时器插入测试的最大定时器数量
+#define START_BENCH_WORKERS             8    // 基准测试工作线程数量 (>= 4)
+#define START_BENCH_UNIT                "cyc"  // DWT CYCCNT 周期数
+#define START_BENCH_BATCH               16   // 接近计数器读取开销的用例每个样本连续执行的次数
+#define START_BENCH_CLOCK_MHZ           72   // 计数器频率 (HCLK)
 
 
 
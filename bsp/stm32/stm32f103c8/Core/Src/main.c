@@ -21,7 +21,9 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#if START_USING_BENCH
+#include "bench.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -115,6 +117,10 @@ int main(void)
   /* USER CODE BEGIN 2 */
 	s_start_init();
 
+#if START_USING_BENCH
+  /* Benchmark table on USART1 instead of the demo threads. */
+  bench_init();
+#else
   s_mutex_init(&mutex1,START_IPC_FLAG_FIFO);
 
 	s_thread_init(&thread1,
@@ -138,6 +144,7 @@ int main(void)
             15,
             10);
   s_thread_startup(&thread3);
+#endif
 
 	s_sched_start();
   /* USER CODE END 2 */
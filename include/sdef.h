@@ -74,14 +74,84 @@ typedef struct thread
 
     s_uint8_t   current_priority; /**< Current (possibly boosted) priority */
     s_uint8_t   init_priority;    /**< Original priority at creation */
+#if START_THREAD_PRIORITY_MAX > 32
+    s_uint8_t   number;           /**< Ready group index (priority >> 5) */
+    s_uint32_t  high_mask;        /**< Bit mask inside the ready group word */
+#endif
     s_uint32_t  number_mask;      /**< Bit mask for ready group */
 
     s_uint32_t  init_tick;        /**< Time slice length (ticks) */
     s_uint32_t  remaining_tick;   /**< Remaining time slice */
     s_int32_t   status;           /**< Thread lifecycle status flags */
     s_timer     timer;            /**< Per-thread sleep/timeout timer */
+#if START_USING_IPC && START_USING_EVENT
+    s_uint32_t  event_set;        /**< Event flags waited for, then the flags received */
+    s_uint8_t   event_info;       /**< Event wait option, 0 once satisfied by a sender */
+#endif
+#if START_USING_THREAD_NOTIFY
+    s_uint32_t  notify_value;     /**< Notification value (bits / count / word) */
+    s_uint8_t   notify_state;     /**< START_NOTIFY_STATE_* */
+#endif
+#if START_USING_RUNTIME_STATS
+    s_list      glist;            /**< Node in the global thread list */
+    s_uint64_t  runtime;          /**< Accumulated CPU time (s_cycle_get units) */
+#endif
 } s_thread, *s_pthread;
+
+#if START_USING_RUNTIME_STATS
+/**
+ * @brief Per-thread entry filled by s_thread_stats_snapshot().
+ */
+typedef struct thread_stat
+{
+    s_pthread   thread;           /**< Thread control block */
+    s_uint64_t  runtime;          /**< Accumulated CPU time (s_cycle_get units) */
+    s_uint8_t   current_priority; /**< Priority at snapshot time */
+    s_int32_t   status;           /**< Status at snapshot time */
+} s_thread_stat;
+#endif
 #if START_USING_IPC
+#ifndef START_IPC_WAIT_POOL
+#define START_IPC_WAIT_POOL   4       /**< PRIO wait queues with per-priority heads */
+#endif
+#ifndef START_MUTEX_FAST_PATH
+#define START_MUTEX_FAST_PATH 0       /**< Needs LDREX/STREX (ARMv7-M) or host atomics */
+#endif
+
+#if START_IPC_WAIT_POOL > 0
+/**
+ * @brief Per-priority heads of one PRIO wait queue, lent from a pool in ipc.c.
+ * @note Same two-level bitmap as the ready queue. Bits are set on insert and
+ *       cleared lazily by s_waitq_first(), so a waiter may leave with a plain
+ *       s_list_delete(&thread->tlist).
+ */
+typedef struct waitq_levels
+{
+    struct waitq *owner;                              /**< Queue the heads are lent to */
+    s_uint32_t    group;                              /**< Bit n set: priority group (or priority) n may be non-empty */
+#if START_THREAD_PRIORITY_MAX > 32
+    s_uint32_t    table[(START_THREAD_PRIORITY_MAX + 31) / 32]; /**< Priority bits per group */
+#endif
+    s_list        level[START_THREAD_PRIORITY_MAX];   /**< Waiters per priority, tlist nodes */
+} s_waitq_levels;
+#endif
+
+/**
+ * @brief IPC wait queue: a plain list (FIFO order), or for PRIO queues one
+ *        list per priority borrowed from the pool at init.
+ */
+typedef struct waitq
+{
+    s_list          list;   /**< FIFO waiters (PRIO waiters if START_IPC_WAIT_POOL is 0) */
+#if START_IPC_WAIT_POOL > 0
+    s_waitq_levels *prio;   /**< PRIO priority heads, NULL for FIFO */
+#endif
+} s_waitq;
+
+#if START_USING_WAITSET
+struct waitset;
+#endif
+
 /**
  * @brief Common IPC parent header embedded in IPC objects.
  */
@@ -89,7 +159,10 @@ struct ipc_parent
 {
     s_uint8_t status;             /**< 1 = valid, 0 = deleted */
     s_uint8_t flag;               /**< Queueing policy / mode */
-    s_list    suspend_thread;     /**< Waiting thread list head */
+    s_waitq   suspend_thread;     /**< Waiting threads */
+#if START_USING_WAITSET
+    struct waitset *set;          /**< Wait set this object is a member of */
+#endif
 };
 
 #if START_USING_SEMAPHORE
@@ -111,7 +184,7 @@ typedef struct semaphore
 typedef struct mutex
 {
     struct ipc_parent parent;       /**< Base IPC header */
-    s_pthread          owner;       /**< Owning thread */
+    s_pthread          owner;       /**< Owning thread (bit 0: threads queued) */
     s_uint16_t         count;       /**< Availability (1 free, 0 taken) */
     s_uint8_t          original_priority; /**< Owner original priority before inheritance */
     s_uint8_t          hold;        /**< Recursive acquisition depth */
@@ -132,7 +205,7 @@ typedef struct
     void             *msg_queue_head;  /**< FIFO head (linked nodes) */
     void             *msg_queue_tail;  /**< FIFO tail */
     void             *msg_queue_free;  /**< Free node stack head */
-    s_list            suspend_sender_thread; /**< Sender wait list */
+    s_waitq           suspend_sender_thread; /**< Sender wait list */
 } s_msgqueue, *s_pmsgqueue;
 
 /**
@@ -145,6 +218,169 @@ struct s_mq_message
 };
 #endif
 
+#if START_USING_MAILBOX
+/**
+ * @brief Mailbox: circular array of 32-bit slots (values / buffer pointers).
+ */
+typedef struct mailbox
+{
+    struct ipc_parent parent;        /**< Base IPC header (receiver wait list) */
+    s_uint32_t       *msg_pool;      /**< Slot array */
+    s_uint16_t        size;          /**< Slot count */
+    s_uint16_t        entry;         /**< Occupied slots */
+    s_uint16_t        in_offset;     /**< Next slot written by send */
+    s_uint16_t        out_offset;    /**< Next slot read by recv */
+    s_waitq           suspend_sender_thread; /**< Sender wait list */
+} s_mailbox, *s_pmailbox;
+#endif
+
+#if START_USING_RINGBUF
+/**
+ * @brief Lock-free SPSC ring buffer (one producer, one consumer thread).
+ */
+typedef struct ringbuf
+{
+    struct ipc_parent   parent;     /**< Base IPC header (consumer wait list) */
+    s_uint8_t          *buffer;     /**< Storage, (mask + 1) * elem_size bytes */
+    s_uint32_t          mask;       /**< Element capacity - 1 (capacity is 2^n) */
+    s_uint32_t          trigger;    /**< Fill level that wakes the consumer */
+    s_uint16_t          elem_size;  /**< Bytes per element */
+    volatile s_uint32_t head;       /**< Free-running write index (producer only) */
+    volatile s_uint32_t tail;       /**< Free-running read index (consumer only) */
+    volatile s_uint32_t wait_level; /**< Level the sleeping consumer waits for, 0 = awake */
+} s_ringbuf, *s_pringbuf;
+#endif
+
+#if START_USING_STREAM
+/**
+ * @brief Byte stream: one contiguous FIFO buffer, no per-message header.
+ */
+typedef struct stream
+{
+    struct ipc_parent parent;        /**< Base IPC header (reader wait list) */
+    s_uint8_t        *buffer;        /**< Storage, size bytes */
+    s_uint32_t        size;          /**< Buffer size in bytes */
+    s_uint32_t        used;          /**< Bytes not free for writers (claimed or stored) */
+    s_uint32_t        avail;         /**< Bytes readers may claim */
+    s_uint32_t        filled;        /**< Copied in, published when writers drops to 0 */
+    s_uint32_t        drained;       /**< Copied out, released when readers drops to 0 */
+    s_uint32_t        in_offset;     /**< Next byte written */
+    s_uint32_t        out_offset;    /**< Next byte read */
+    s_uint32_t        trigger;       /**< Readable bytes that wake a blocked reader */
+    s_uint32_t        read_level;    /**< Level the first blocked reader waits for */
+    s_uint8_t         writers;       /**< Writers copying in */
+    s_uint8_t         readers;       /**< Readers copying out */
+    s_waitq           suspend_writer_thread; /**< Writer wait list */
+} s_stream, *s_pstream;
+#endif
+
+#if START_USING_VMSGQUEUE
+/**
+ * @brief Variable-length message queue: length-prefixed records packed back
+ *        to back in a byte ring.
+ */
+typedef struct vmsgqueue
+{
+    struct ipc_parent parent;        /**< Base IPC header (receiver wait list) */
+    s_uint8_t        *pool;          /**< Record storage */
+    s_uint32_t        pool_size;     /**< Pool size in bytes */
+    s_uint32_t        used;          /**< Bytes claimed or stored, length prefixes included */
+    s_uint32_t        drained;       /**< Copied out, released when receivers drops to 0 */
+    s_uint32_t        in_offset;     /**< Where the next record is written */
+    s_uint32_t        out_offset;    /**< Oldest record */
+    s_uint16_t        entry;         /**< Messages receivers may claim */
+    s_uint16_t        filled;        /**< Copied in, published when senders drops to 0 */
+    s_uint8_t         senders;       /**< Senders copying in */
+    s_uint8_t         receivers;     /**< Receivers copying out */
+    s_waitq           suspend_sender_thread; /**< Sender wait list */
+} s_vmsgqueue, *s_pvmsgqueue;
+#endif
+
+#if START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE
+/**
+ * @brief Priority message queue: fixed-size nodes (msgqueue layout) kept in
+ *        one FIFO sublist per priority, plus a bitmap of non-empty sublists.
+ */
+typedef struct prioqueue
+{
+    struct ipc_parent    parent;     /**< Base IPC header (receiver wait list) */
+    void                *msg_pool;   /**< Raw pool base */
+    s_uint16_t           msg_size;   /**< Aligned payload size */
+    s_uint16_t           max_msgs;   /**< Maximum storable messages */
+    s_uint16_t           index;      /**< Current queued count */
+    s_uint32_t           ready;      /**< Bit n set: sublist n not empty */
+    struct s_mq_message *head[START_PRIOQ_LEVELS]; /**< Per-priority FIFO heads */
+    struct s_mq_message *tail[START_PRIOQ_LEVELS]; /**< Per-priority FIFO tails */
+    struct s_mq_message *msg_queue_free;           /**< Free node stack head */
+    s_waitq              suspend_sender_thread;    /**< Sender wait list */
+} s_prioqueue, *s_pprioqueue;
+#endif
+
+#if START_USING_EVENT
+/**
+ * @brief Event flag group (32 independent flags).
+ */
+typedef struct event
+{
+    struct ipc_parent parent; /**< Base IPC header */
+    s_uint32_t        set;    /**< Pending flags */
+} s_event, *s_pevent;
+#endif
+
+#if START_USING_MUTEX && START_USING_COND
+/**
+ * @brief Condition variable, used together with an s_mutex.
+ */
+typedef struct cond
+{
+    struct ipc_parent parent; /**< Base IPC header (waiting threads) */
+    s_pmutex          mutex;  /**< Mutex the waiters released */
+} s_cond, *s_pcond;
+#endif
+
+#if START_USING_RWLOCK
+/**
+ * @brief Reader-writer lock: shared readers, one exclusive writer.
+ */
+typedef struct rwlock
+{
+    struct ipc_parent parent;                /**< Base IPC header (blocked readers) */
+    s_waitq           suspend_writer_thread; /**< Blocked writers */
+    s_pthread         owner;                 /**< Writer holding the lock, NULL if none */
+    s_uint16_t        readers;               /**< Readers holding the lock */
+    s_uint16_t        writers;               /**< Writers blocked (or woken, not yet running) */
+    s_uint8_t         original_priority;     /**< Writer priority before inheritance */
+    s_uint8_t         prefer;                /**< START_RWLOCK_PREFER_READER / _WRITER */
+} s_rwlock, *s_prwlock;
+#endif
+
+#if START_USING_BARRIER
+/**
+ * @brief Barrier: every phase releases once parties threads have arrived.
+ */
+typedef struct barrier
+{
+    struct ipc_parent parent;  /**< Base IPC header (threads waiting for the phase) */
+    s_uint16_t        parties; /**< Threads per phase */
+    s_uint16_t        arrived; /**< Threads arrived in the current phase */
+    s_uint32_t        phase;   /**< Completed phases */
+} s_barrier, *s_pbarrier;
+#endif
+
+#if START_USING_WAITSET
+/**
+ * @brief Wait set: block on several semaphores / message queues at once.
+ */
+typedef struct waitset
+{
+    struct ipc_parent  parent;                    /**< Base IPC header (threads in s_waitset_wait) */
+    struct ipc_parent *member[START_WAITSET_MAX]; /**< Registered objects */
+    s_uint8_t          type[START_WAITSET_MAX];   /**< Kind of each member */
+    s_uint8_t          count;                     /**< Registered members */
+    s_uint8_t          next;                      /**< Member scanned first by the next wait */
+} s_waitset, *s_pwaitset;
+#endif
+
 #endif
 
 #define s_inline static inline __attribute__((always_inline))
@@ -167,6 +403,18 @@ struct s_mq_message
 #define START_THREAD_GET_PRIORITY  0x03
 #define START_THREAD_SET_PRIORITY  0x04
 
+#if START_USING_THREAD_NOTIFY
+/* s_thread_notify() actions */
+#define START_NOTIFY_SET_BITS      0x01 /**< value |= arg (event flags) */
+#define START_NOTIFY_INCREMENT     0x02 /**< value += 1, arg ignored (counting semaphore) */
+#define START_NOTIFY_OVERWRITE     0x03 /**< value = arg (mailbox of one word) */
+
+/* Notification state of a thread */
+#define START_NOTIFY_STATE_NONE    0x00 /**< Nothing pending */
+#define START_NOTIFY_STATE_WAIT    0x01 /**< Blocked in s_thread_notify_wait() */
+#define START_NOTIFY_STATE_PENDING 0x02 /**< Notified, not yet received */
+#endif
+
 #if START_DEBUG
 #define START_DEBUG_INFO 0x01
 #define START_DEBUG_WARN 0x02
@@ -187,6 +435,17 @@ struct s_mq_message
 #define MUTEX_HOLD_MAX 0xFF
 #endif
 
+#if START_USING_RWLOCK
+#define START_RWLOCK_PREFER_READER  0x00 /**< New readers join active readers even if a writer waits */
+#define START_RWLOCK_PREFER_WRITER  0x01 /**< A waiting writer blocks new readers */
+#endif
+
+#if START_USING_EVENT
+#define START_EVENT_FLAG_AND    0x01 /**< Wait until every flag of the set is pending */
+#define START_EVENT_FLAG_OR     0x02 /**< Wait until any flag of the set is pending */
+#define START_EVENT_FLAG_CLEAR  0x04 /**< Consume the received flags on return */
+#endif
+
 #if START_USING_MESSAGEQUEUE
 /**
  * @brief Compute memory pool size for a message queue.
@@ -197,6 +456,17 @@ struct s_mq_message
     ( (size_t)(msg_count) * ( START_ALIGN_UP((size_t)(msg_size), START_ALIGN_SIZE) + sizeof(struct s_mq_message) ) )
 #endif
 
+#if START_USING_VMSGQUEUE
+#define START_VMSGQ_HDR_SIZE    2    /**< Length prefix stored before each message */
+/**
+ * @brief Compute pool size for a variable-length message queue.
+ * @param total_bytes Payload bytes of all messages that must fit at once.
+ * @param msg_count Number of those messages.
+ */
+#define START_VMSGQ_POOL_SIZE(total_bytes, msg_count) \
+    ( (size_t)(total_bytes) + (size_t)(msg_count) * START_VMSGQ_HDR_SIZE )
+#endif
+
 #endif
 
 
@@ -220,6 +490,51 @@ struct s_mq_message
 #define S_DEBUG_LOG(level, fmt, ...) ((void)0)
 #endif
 
+#if START_USING_TRACE
+/* Trace event ids (s_trace_event.id) */
+#define S_TRACE_EV_SWITCH         0x01 /**< object = next thread */
+#define S_TRACE_EV_SLEEP          0x02 /**< object = sleep ticks */
+#define S_TRACE_EV_SUSPEND        0x03 /**< object = IPC suspend list */
+#define S_TRACE_EV_SEM_RELEASE    0x04 /**< object = semaphore */
+#define S_TRACE_EV_MUTEX_TAKE     0x05 /**< object = mutex */
+#define S_TRACE_EV_MUTEX_RELEASE  0x06 /**< object = mutex */
+#define S_TRACE_EV_MQ_SEND        0x07 /**< object = message queue */
+#define S_TRACE_EV_MQ_RECV        0x08 /**< object = message queue */
+#define S_TRACE_EV_TIMER          0x09 /**< object = expired timer */
+#define S_TRACE_EV_PRIORITY       0x0A /**< object = thread, arg = new priority */
+
+#define S_TRACE_MAGIC             0x43525453UL /**< "STRC" little endian */
+#define S_TRACE_VERSION           1
+
+/**
+ * @brief One fixed-size (16 byte) trace record.
+ */
+typedef struct trace_event
+{
+    s_uint32_t timestamp;         /**< s_cycle_get() at record time */
+    s_uint32_t thread;            /**< Running thread (address, low 32 bits) */
+    s_uint32_t object;            /**< Event object or value */
+    s_uint8_t  id;                /**< S_TRACE_EV_xxx */
+    s_uint8_t  prio;              /**< Running thread priority */
+    s_uint8_t  arg;               /**< Small event argument */
+    s_uint8_t  lap;               /**< Buffer lap of the slot (stale detection) */
+} s_trace_event;
+
+/**
+ * @brief Trace ring buffer; the header lets host tools decode raw dumps.
+ */
+typedef struct trace_buffer
+{
+    s_uint32_t          magic;    /**< S_TRACE_MAGIC (sync word) */
+    s_uint16_t          version;  /**< S_TRACE_VERSION */
+    s_uint16_t          size;     /**< Event slots (power of two) */
+    s_uint32_t          clock_hz; /**< Timestamp frequency */
+    volatile s_uint32_t head;     /**< Events reserved so far */
+    volatile s_uint32_t enable;   /**< 1 = recording */
+    s_trace_event       events[START_TRACE_EVENTS];
+} s_trace_buffer;
+#endif
+
 #define START_ALIGN_SIZE 4
 #define START_ALIGN_UP(sz, a) ( ((sz) + ((a)-1)) & ~((a)-1) )
 
@@ -57,6 +57,17 @@ void s_irq_enable(s_uint32_t disirq);
  */
 s_uint8_t *s_stack_init(void *entry, s_uint8_t *stackaddr);
 
+/**
+ * @brief Enable the free-running high resolution counter (DWT CYCCNT on Cortex-M3).
+ */
+void s_cycle_init(void);
+
+/**
+ * @brief Read the free-running high resolution counter.
+ * @return CPU cycles on Cortex-M3, nanoseconds on the POSIX host port (wraps).
+ */
+s_uint32_t s_cycle_get(void);
+
 /* Doubly linked intrusive list primitives */
 void s_list_init(s_plist l);
 void s_list_insert_after(s_plist l, s_plist n);
@@ -70,6 +81,12 @@ int  s_list_isempty(s_plist l);
  */
 s_pthread s_thread_get(void);
 
+/**
+ * @brief Get current running thread if it may block now.
+ * @return Thread object, NULL before scheduler start or with the scheduler locked.
+ */
+s_pthread s_thread_get_blockable(void);
+
 /**
  * @brief Initialize core subsystems (scheduler, timer, idle thread, banner).
  * @return S_OK on success.
@@ -87,6 +104,25 @@ void s_start_banner(void);
  */
 void s_printf(const char *fmt, ...);
 
+/**
+ * @brief Weak single character output hook (override for UART / SWO / etc.).
+ * @param c Character to emit.
+ */
+void s_putc(char c);
+
+/**
+ * @brief Copy size bytes word-wise (weak, ports may override).
+ * @note Regions must not overlap.
+ * @return dst.
+ */
+void *s_memcpy(void *dst, const void *src, s_uint32_t size);
+
+/**
+ * @brief Fill size bytes with (s_uint8_t)c word-wise (weak, ports may override).
+ * @return dst.
+ */
+void *s_memset(void *dst, int c, s_uint32_t size);
+
 /* Scheduler control APIs */
 void s_sched_init(void);
 void s_sched_start(void);
@@ -96,11 +132,76 @@ void s_sched_insert_thread(s_pthread thread);
 void s_thread_yield(void);
 void s_cleanup_defunct_threads(void);
 
+/**
+ * @brief ISR nesting bookkeeping: wrap ISR bodies that release IPC objects
+ *        or wake threads; s_tick_increase() does this internally.
+ */
+void      s_interrupt_enter(void);
+void      s_interrupt_leave(void);
+s_uint8_t s_interrupt_get_nest(void);
+
+/**
+ * @brief Nestable scheduler lock: defers rescheduling (not interrupts) so
+ *        bulk startups / posts end in a single switch on the final unlock.
+ */
+void      s_sched_lock(void);
+void      s_sched_unlock(void);
+s_uint8_t s_sched_get_lock_nest(void);
+
+#if START_USING_TRACE
+/** Trace ring buffer (dump this symbol from a debugger). */
+extern s_trace_buffer s_trace_buf;
+
+void s_trace_init(void);
+void s_trace_start(void);
+void s_trace_stop(void);
+
+/**
+ * @brief Append one event to the trace ring buffer (thread / ISR safe).
+ * @param id S_TRACE_EV_xxx.
+ * @param object Event object (pointer or value, truncated to 32 bits).
+ * @param arg Small event argument.
+ */
+void s_trace_record(s_uint8_t id, s_uint32_t object, s_uint8_t arg);
+
+/**
+ * @brief Stream the trace buffer as raw bytes through s_putc().
+ */
+void s_trace_dump(void);
+
+#define S_TRACE(id, object, arg) \
+    s_trace_record((id), (s_uint32_t)(unsigned long)(object), (s_uint8_t)(arg))
+#else
+#define S_TRACE(id, object, arg) ((void)0)
+#endif
+
+#if START_USING_RUNTIME_STATS
+/**
+ * @brief Charge the running thread with the CPU time used up to now.
+ */
+void s_sched_runtime_update(void);
+
+/**
+ * @brief Snapshot runtime of all live threads (see s_thread_stat).
+ * @param buf Destination array (may be NULL to count threads).
+ * @param max Capacity of buf.
+ * @param total Optional: total CPU time charged since start.
+ * @return Number of live threads.
+ */
+s_uint32_t s_thread_stats_snapshot(s_thread_stat *buf, s_uint32_t max, s_uint64_t *total);
+
+/**
+ * @brief CPU load in permille since the previous call (idle thread based).
+ */
+s_uint32_t s_system_load_get(void);
+#endif
+
 /**
  * @brief Put current thread to sleep (block) for tick count.
  * @param tick Number of ticks to sleep.
+ * @return S_OK, S_UNSUPPORTED (no thread context or scheduler locked).
  */
-void s_thread_sleep(s_uint32_t tick);
+s_status s_thread_sleep(s_uint32_t tick);
 
 /**
  * @brief Terminate current thread (deferred cleanup by idle).
@@ -117,7 +218,7 @@ void s_thread_exit(void);
  * @param tick Time slice (ticks).
  * @return S_OK on success, else error code.
  */
-s_status s_thread_init(s_pthread thread,void *entry,void *stackaddr,s_uint32_t stacksize,s_int8_t priority,s_uint32_t tick);
+s_status s_thread_init(s_pthread thread,void *entry,void *stackaddr,s_uint32_t stacksize,s_uint8_t priority,s_uint32_t tick);
 
 /**
  * @brief Move an initialized thread into ready state.
@@ -132,6 +233,24 @@ s_status s_thread_suspend(s_pthread thread);
 s_status s_thread_ctrl(s_pthread thread, s_uint32_t cmd, void *arg);
 s_status s_thread_restart(s_pthread thread);
 
+#if START_USING_THREAD_NOTIFY
+/**
+ * @brief Notify a thread: update its notification value and wake it.
+ * @param action START_NOTIFY_SET_BITS / _INCREMENT / _OVERWRITE.
+ * @note Never blocks; callable from an ISR wrapped in s_interrupt_enter/leave.
+ */
+s_status s_thread_notify(s_pthread thread, s_uint32_t value, s_uint8_t action);
+
+/**
+ * @brief Wait for a notification of the calling thread.
+ * @param clear Bits of the value cleared on return (0xFFFFFFFF: reset).
+ * @param value Receives the value before clearing (may be NULL).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT, S_UNSUPPORTED (no thread context or scheduler locked).
+ */
+s_status s_thread_notify_wait(s_uint32_t clear, s_uint32_t *value, s_int32_t timeout);
+#endif
+
 /* Timer subsystem */
 void      s_timer_list_init(void);
 void      s_mdelay(s_uint32_t ms);
@@ -145,8 +264,35 @@ s_status  s_timer_stop(s_ptimer timer);
 s_status  s_timer_start(s_ptimer timer);
 void      timeout_function(void *p);
 
+#if START_USING_TICKLESS
+/** Returned by s_timer_next_timeout() when no timer is armed. */
+#define START_TICKLESS_FOREVER 0xFFFFFFFFUL
+
+s_uint32_t s_timer_next_timeout(void);
+void       s_tick_compensate(s_uint32_t ticks);
+void       s_tickless_idle(void);
+s_uint32_t s_tickless_split(s_uint32_t cycles_per_tick, s_uint32_t into,
+                            s_uint32_t elapsed, s_uint32_t *reload);
+
+/**
+ * @brief Port hook: stop the periodic tick and sleep (WFI) for up to ticks.
+ * @param ticks Ticks until the next timer expiry (>= START_TICKLESS_MIN_TICKS).
+ * @return Whole ticks elapsed, excluding the one a pending tick IRQ delivers.
+ * @note Called from idle with IRQs disabled; must restart the periodic tick.
+ */
+s_uint32_t s_cpu_tickless_sleep(s_uint32_t ticks);
+#endif
+
 #if START_USING_IPC
-/* IPC: semaphore / mutex / message queue APIs */
+/* IPC: common wait list helpers (used by IPC objects outside ipc.c) */
+s_status  s_ipc_suspend(s_waitq *q, s_pthread thread, s_uint8_t flag);
+s_status  s_ipc_list_resume_all(s_waitq *q);
+s_status  s_waitq_init(s_waitq *q, s_uint8_t flag);
+void      s_waitq_deinit(s_waitq *q);
+s_uint8_t s_waitq_isempty(s_waitq *q);
+s_pthread s_waitq_first(s_waitq *q);
+
+/* IPC: semaphore / mutex / message queues / mailbox / ring buffer / stream / event APIs */
 #if START_USING_SEMAPHORE
 s_status s_sem_init(s_psem sem, s_uint16_t value, s_uint8_t flag);
 s_status s_sem_delete(s_psem sem);
@@ -166,6 +312,97 @@ s_status s_msgqueue_send_wait(s_pmsgqueue mq, const void *buffer, s_uint16_t siz
 s_status s_msgqueue_send(s_pmsgqueue mq, const void *buffer, s_uint16_t size);
 s_status s_msgqueue_urgent(s_pmsgqueue mq, const void *buffer, s_uint16_t size);
 s_status s_msgqueue_recv(s_pmsgqueue mq, void *buffer, s_uint16_t size, s_int32_t timeout);
+/* Zero-copy: fill / read pool slots in place (payload is msg_size bytes). */
+s_status s_msgqueue_alloc(s_pmsgqueue mq, void **buffer, s_int32_t timeout);
+s_status s_msgqueue_commit(s_pmsgqueue mq, void *buffer);
+s_status s_msgqueue_recv_ptr(s_pmsgqueue mq, void **buffer, s_int32_t timeout);
+s_status s_msgqueue_release(s_pmsgqueue mq, void *buffer);
+#endif
+#if START_USING_MAILBOX
+s_status s_mailbox_init(s_pmailbox mb, s_uint32_t *msg_pool, s_uint16_t size, s_uint8_t flag);
+s_status s_mailbox_delete(s_pmailbox mb);
+s_status s_mailbox_send_wait(s_pmailbox mb, s_uint32_t value, s_int32_t timeout);
+s_status s_mailbox_send(s_pmailbox mb, s_uint32_t value);
+s_status s_mailbox_recv(s_pmailbox mb, s_uint32_t *value, s_int32_t timeout);
+/* Never block; a wakeup switch is deferred to s_interrupt_leave(). */
+s_status s_mailbox_send_from_isr(s_pmailbox mb, s_uint32_t value);
+s_status s_mailbox_recv_from_isr(s_pmailbox mb, s_uint32_t *value);
+#endif
+#if START_USING_RINGBUF
+s_status   s_ringbuf_init(s_pringbuf rb, void *buffer, s_uint16_t elem_size,
+                          s_uint32_t count, s_uint32_t trigger);
+s_uint32_t s_ringbuf_count(s_pringbuf rb);
+/* Producer side, ISR safe; consumer side may block (single consumer thread). */
+s_uint32_t s_ringbuf_write(s_pringbuf rb, const void *data, s_uint32_t n);
+s_uint32_t s_ringbuf_read(s_pringbuf rb, void *data, s_uint32_t n, s_int32_t timeout);
+#endif
+#if START_USING_STREAM
+s_status   s_stream_init(s_pstream st, void *buffer, s_uint32_t size,
+                         s_uint32_t trigger, s_uint8_t flag);
+s_status   s_stream_delete(s_pstream st);
+s_uint32_t s_stream_count(s_pstream st);
+s_uint32_t s_stream_write(s_pstream st, const void *data, s_uint32_t len, s_int32_t timeout);
+s_uint32_t s_stream_read(s_pstream st, void *data, s_uint32_t len, s_int32_t timeout);
+s_uint32_t s_stream_write_from_isr(s_pstream st, const void *data, s_uint32_t len);
+s_uint32_t s_stream_read_from_isr(s_pstream st, void *data, s_uint32_t len);
+#endif
+#if START_USING_VMSGQUEUE
+s_status s_vmsgqueue_init(s_pvmsgqueue vq, void *pool, s_uint32_t pool_size, s_uint8_t flag);
+s_status s_vmsgqueue_delete(s_pvmsgqueue vq);
+s_status s_vmsgqueue_send_wait(s_pvmsgqueue vq, const void *buffer, s_uint16_t size, s_int32_t timeout);
+s_status s_vmsgqueue_send(s_pvmsgqueue vq, const void *buffer, s_uint16_t size);
+s_status s_vmsgqueue_recv(s_pvmsgqueue vq, void *buffer, s_uint16_t size,
+                          s_uint16_t *len, s_int32_t timeout);
+#endif
+#if START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE
+s_status s_prioqueue_init(s_pprioqueue pq, void *msg_pool, s_uint16_t msg_size,
+                          s_uint16_t pool_size, s_uint8_t flag);
+s_status s_prioqueue_delete(s_pprioqueue pq);
+/* prio 0 is the most urgent; recv returns the oldest message of the most urgent level. */
+s_status s_prioqueue_send_wait(s_pprioqueue pq, const void *buffer, s_uint16_t size,
+                               s_uint8_t prio, s_int32_t timeout);
+s_status s_prioqueue_send(s_pprioqueue pq, const void *buffer, s_uint16_t size, s_uint8_t prio);
+s_status s_prioqueue_recv(s_pprioqueue pq, void *buffer, s_uint16_t size,
+                          s_uint8_t *prio, s_int32_t timeout);
+#endif
+#if START_USING_EVENT
+s_status s_event_init(s_pevent event, s_uint8_t flag);
+s_status s_event_delete(s_pevent event);
+s_status s_event_send(s_pevent event, s_uint32_t set);
+s_status s_event_recv(s_pevent event, s_uint32_t set, s_uint8_t option,
+                      s_int32_t timeout, s_uint32_t *recved);
+#endif
+#if START_USING_MUTEX && START_USING_COND
+s_status s_cond_init(s_pcond cond, s_uint8_t flag);
+s_status s_cond_delete(s_pcond cond);
+s_status s_cond_wait(s_pcond cond, s_pmutex mutex, s_int32_t timeout);
+s_status s_cond_signal(s_pcond cond);
+s_status s_cond_broadcast(s_pcond cond);
+#endif
+#if START_USING_RWLOCK
+s_status s_rwlock_init(s_prwlock rw, s_uint8_t flag, s_uint8_t prefer);
+s_status s_rwlock_delete(s_prwlock rw);
+s_status s_rwlock_take_read(s_prwlock rw, s_int32_t timeout);
+s_status s_rwlock_take_write(s_prwlock rw, s_int32_t timeout);
+s_status s_rwlock_release(s_prwlock rw);
+#endif
+#if START_USING_BARRIER
+s_status s_barrier_init(s_pbarrier barrier, s_uint16_t parties, s_uint8_t flag);
+s_status s_barrier_delete(s_pbarrier barrier);
+s_status s_barrier_wait(s_pbarrier barrier, s_int32_t timeout);
+#endif
+#if START_USING_WAITSET
+s_status s_waitset_init(s_pwaitset ws, s_uint8_t flag);
+s_status s_waitset_delete(s_pwaitset ws);
+#if START_USING_SEMAPHORE
+s_status s_waitset_add_sem(s_pwaitset ws, s_psem sem);
+#endif
+#if START_USING_MESSAGEQUEUE
+s_status s_waitset_add_msgqueue(s_pwaitset ws, s_pmsgqueue mq);
+#endif
+s_status s_waitset_remove(s_pwaitset ws, void *object);
+/* Reports a ready member without consuming it; take it with START_WAITING_NO. */
+s_status s_waitset_wait(s_pwaitset ws, void **ready, s_int32_t timeout);
 #endif
 
 #endif
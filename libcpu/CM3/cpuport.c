@@ -1,6 +1,6 @@
 /**
  * @file cpuport.c
- * @brief Cortex-M3 CPU port: stack frame initialization & ffs helper.
+ * @brief Cortex-M3 CPU port: stack frame initialization, ffs and memcpy helpers.
  * @version 1.0.2
  * @date 2025-08-26
  * author
@@ -70,6 +70,106 @@ s_uint8_t *s_stack_init(void *entry, s_uint8_t *stackaddr)
     return psp;
 }
 
+/* Data Watchpoint and Trace unit (cycle counter) */
+#define DWT_CTRL        (*(volatile s_uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT      (*(volatile s_uint32_t *)0xE0001004UL)
+#define DEM_CR          (*(volatile s_uint32_t *)0xE000EDFCUL)
+#define DEM_CR_TRCENA   (1UL << 24)
+#define DWT_CTRL_CYCEN  (1UL << 0)
+
+/**
+ * @brief Enable DWT cycle counter.
+ */
+void s_cycle_init(void)
+{
+    DEM_CR     |= DEM_CR_TRCENA;
+    DWT_CYCCNT  = 0;
+    DWT_CTRL   |= DWT_CTRL_CYCEN;
+}
+
+/**
+ * @brief Read DWT cycle counter.
+ */
+s_uint32_t s_cycle_get(void)
+{
+    return DWT_CYCCNT;
+}
+
+#if START_USING_TICKLESS
+/* SysTick registers */
+#define SYST_CTRL             (*(volatile s_uint32_t *)0xE000E010UL)
+#define SYST_LOAD             (*(volatile s_uint32_t *)0xE000E014UL)
+#define SYST_VAL              (*(volatile s_uint32_t *)0xE000E018UL)
+#define SYST_CTRL_ENABLE      (1UL << 0)
+#define SYST_CTRL_COUNTFLAG   (1UL << 16)
+#define SYST_LOAD_MAX         0x00FFFFFFUL
+
+#if defined(__CC_ARM)
+#define S_CPU_WFI()  do { __dsb(0xF); __wfi(); __isb(0xF); } while (0)
+#else
+#define S_CPU_WFI()  __asm volatile ("dsb\n wfi\n isb" ::: "memory")
+#endif
+
+/**
+ * @brief Stretch SysTick over several ticks and WFI (PRIMASK set by caller).
+ * @param ticks Ticks until the next timer expiry.
+ * @return Whole ticks elapsed, excluding the one the pending SysTick delivers.
+ */
+s_uint32_t s_cpu_tickless_sleep(s_uint32_t ticks)
+{
+    static s_uint32_t cycles_per_tick;
+    s_uint32_t reload;
+    s_uint32_t ctrl;
+    s_uint32_t into;
+    s_uint32_t completed;
+
+    /* SysTick reload configured by the BSP (SystemCoreClock / START_TICK). */
+    if (cycles_per_tick == 0)
+        cycles_per_tick = SYST_LOAD + 1;
+
+    if (ticks > SYST_LOAD_MAX / cycles_per_tick)
+        ticks = SYST_LOAD_MAX / cycles_per_tick;
+
+    /* Stop and reload with the remainder of this tick plus (ticks-1) more. */
+    SYST_CTRL &= ~SYST_CTRL_ENABLE;
+    reload  = SYST_VAL;
+    into    = cycles_per_tick - reload;
+    reload += cycles_per_tick * (ticks - 1);
+    SYST_LOAD = reload;
+    SYST_VAL  = 0;
+    SYST_CTRL |= SYST_CTRL_ENABLE;
+
+    S_CPU_WFI();
+
+    /* Reading CTRL clears COUNTFLAG: sample it once. */
+    ctrl = SYST_CTRL;
+    SYST_CTRL = ctrl & ~SYST_CTRL_ENABLE;
+
+    if (ctrl & SYST_CTRL_COUNTFLAG)
+    {
+        /* Full period elapsed: SysTick IRQ is pending for the last tick. */
+        s_uint32_t late = reload - SYST_VAL;
+        completed = ticks - 1;
+        SYST_LOAD = (late < cycles_per_tick) ? (cycles_per_tick - 1 - late) : (cycles_per_tick - 1);
+    }
+    else
+    {
+        /* Woken early by another interrupt: count on the original tick
+         * grid, including the part of the tick run before the sleep. */
+        completed = s_tickless_split(cycles_per_tick, into,
+                                     reload - SYST_VAL, &reload);
+        SYST_LOAD = reload;
+    }
+
+    /* Run the partial period, then fall back to the normal reload. */
+    SYST_VAL  = 0;
+    SYST_CTRL |= SYST_CTRL_ENABLE;
+    SYST_LOAD = cycles_per_tick - 1;
+
+    return completed;
+}
+#endif
+
 #if START_USING_CPU_FFS
 /* Architecture-specific __s_ffs provided in assembly/inline blocks below. */
 #if defined(__CC_ARM)
@@ -129,3 +229,195 @@ int __s_ffs(int value)
 #endif
 }
 #endif
+
+/*
+ * Word-wise memcpy / memset with 4-word LDM/STM bursts (override the weak C
+ * versions in service.c). Both keep the C contract: bytes up to the first
+ * word boundary, 16-byte bursts, single words, then the byte tail; a
+ * mutually misaligned memcpy copies bytes only.
+ */
+#if defined(__CC_ARM)
+__asm void *s_memcpy(void *dst, const void *src, s_uint32_t size)
+{
+    MOV     r12, r0
+    EOR     r3, r0, r1
+    LSLS    r3, r3, #30
+    BNE     cpy_tail
+cpy_head
+    LSLS    r3, r0, #30
+    BEQ     cpy_words
+    SUBS    r2, r2, #1
+    BCC     cpy_done
+    LDRB    r3, [r1], #1
+    STRB    r3, [r0], #1
+    B       cpy_head
+cpy_words
+    PUSH    {r4-r6}
+    SUBS    r2, r2, #16
+    BCC     cpy_burst_end
+cpy_burst
+    LDMIA   r1!, {r3-r6}
+    STMIA   r0!, {r3-r6}
+    SUBS    r2, r2, #16
+    BCS     cpy_burst
+cpy_burst_end
+    POP     {r4-r6}
+    ADDS    r2, r2, #12
+    BCC     cpy_word_end
+cpy_word
+    LDR     r3, [r1], #4
+    STR     r3, [r0], #4
+    SUBS    r2, r2, #4
+    BCS     cpy_word
+cpy_word_end
+    ADDS    r2, r2, #4
+cpy_tail
+    SUBS    r2, r2, #1
+    BCC     cpy_done
+    LDRB    r3, [r1], #1
+    STRB    r3, [r0], #1
+    B       cpy_tail
+cpy_done
+    MOV     r0, r12
+    BX      lr
+}
+
+__asm void *s_memset(void *dst, int c, s_uint32_t size)
+{
+    MOV     r12, r0
+    UXTB    r1, r1
+    ORR     r1, r1, r1, LSL #8
+    ORR     r1, r1, r1, LSL #16
+set_head
+    LSLS    r3, r0, #30
+    BEQ     set_words
+    SUBS    r2, r2, #1
+    BCC     set_done
+    STRB    r1, [r0], #1
+    B       set_head
+set_words
+    PUSH    {r4-r5}
+    MOV     r3, r1
+    MOV     r4, r1
+    MOV     r5, r1
+    SUBS    r2, r2, #16
+    BCC     set_burst_end
+set_burst
+    STMIA   r0!, {r1, r3-r5}
+    SUBS    r2, r2, #16
+    BCS     set_burst
+set_burst_end
+    POP     {r4-r5}
+    ADDS    r2, r2, #12
+    BCC     set_word_end
+set_word
+    STR     r1, [r0], #4
+    SUBS    r2, r2, #4
+    BCS     set_word
+set_word_end
+    ADDS    r2, r2, #4
+set_tail
+    SUBS    r2, r2, #1
+    BCC     set_done
+    STRB    r1, [r0], #1
+    B       set_tail
+set_done
+    MOV     r0, r12
+    BX      lr
+}
+#elif defined(__GNUC__) || defined(__CLANG_ARM)
+__attribute__((naked)) void *s_memcpy(void *dst, const void *src, s_uint32_t size)
+{
+    __asm volatile(
+        ".syntax unified              \n"
+        "MOV     r12, r0              \n"
+        "EOR     r3, r0, r1           \n"
+        "LSLS    r3, r3, #30          \n"
+        "BNE     5f                   \n"
+        "1:                           \n" /* head: bytes to word boundary */
+        "LSLS    r3, r0, #30          \n"
+        "BEQ     2f                   \n"
+        "SUBS    r2, r2, #1           \n"
+        "BCC     6f                   \n"
+        "LDRB    r3, [r1], #1         \n"
+        "STRB    r3, [r0], #1         \n"
+        "B       1b                   \n"
+        "2:                           \n" /* 16-byte bursts */
+        "PUSH    {r4-r6}              \n"
+        "SUBS    r2, r2, #16          \n"
+        "BCC     3f                   \n"
+        "7:                           \n"
+        "LDMIA   r1!, {r3-r6}         \n"
+        "STMIA   r0!, {r3-r6}         \n"
+        "SUBS    r2, r2, #16          \n"
+        "BCS     7b                   \n"
+        "3:                           \n" /* single words */
+        "POP     {r4-r6}              \n"
+        "ADDS    r2, r2, #12          \n"
+        "BCC     4f                   \n"
+        "8:                           \n"
+        "LDR     r3, [r1], #4         \n"
+        "STR     r3, [r0], #4         \n"
+        "SUBS    r2, r2, #4           \n"
+        "BCS     8b                   \n"
+        "4:                           \n"
+        "ADDS    r2, r2, #4           \n"
+        "5:                           \n" /* byte tail */
+        "SUBS    r2, r2, #1           \n"
+        "BCC     6f                   \n"
+        "LDRB    r3, [r1], #1         \n"
+        "STRB    r3, [r0], #1         \n"
+        "B       5b                   \n"
+        "6:                           \n"
+        "MOV     r0, r12              \n"
+        "BX      lr                   \n"
+    );
+}
+
+__attribute__((naked)) void *s_memset(void *dst, int c, s_uint32_t size)
+{
+    __asm volatile(
+        ".syntax unified              \n"
+        "MOV     r12, r0              \n"
+        "UXTB    r1, r1               \n"
+        "ORR     r1, r1, r1, LSL #8   \n"
+        "ORR     r1, r1, r1, LSL #16  \n"
+        "1:                           \n" /* head: bytes to word boundary */
+        "LSLS    r3, r0, #30          \n"
+        "BEQ     2f                   \n"
+        "SUBS    r2, r2, #1           \n"
+        "BCC     6f                   \n"
+        "STRB    r1, [r0], #1         \n"
+        "B       1b                   \n"
+        "2:                           \n" /* 16-byte bursts */
+        "PUSH    {r4-r5}              \n"
+        "MOV     r3, r1               \n"
+        "MOV     r4, r1               \n"
+        "MOV     r5, r1               \n"
+        "SUBS    r2, r2, #16          \n"
+        "BCC     3f                   \n"
+        "7:                           \n"
+        "STMIA   r0!, {r1, r3-r5}     \n"
+        "SUBS    r2, r2, #16          \n"
+        "BCS     7b                   \n"
+        "3:                           \n" /* single words */
+        "POP     {r4-r5}              \n"
+        "ADDS    r2, r2, #12          \n"
+        "BCC     4f                   \n"
+        "8:                           \n"
+        "STR     r1, [r0], #4         \n"
+        "SUBS    r2, r2, #4           \n"
+        "BCS     8b                   \n"
+        "4:                           \n"
+        "ADDS    r2, r2, #4           \n"
+        "5:                           \n" /* byte tail */
+        "SUBS    r2, r2, #1           \n"
+        "BCC     6f                   \n"
+        "STRB    r1, [r0], #1         \n"
+        "B       5b                   \n"
+        "6:                           \n"
+        "MOV     r0, r12              \n"
+        "BX      lr                   \n"
+    );
+}
+#endif
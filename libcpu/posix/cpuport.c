@@ -0,0 +1,348 @@
+/**
+ * @file cpuport.c
+ * @brief POSIX host port: ucontext threads, SIGALRM SysTick, virtual IRQ mask.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Runs the unchanged kernel inside a single Linux process so the scheduler,
+ *   timer and IPC paths can be profiled with perf and sanitizers.
+ *
+ *   - Every thread owns a ucontext_t placed at the top of its stack; the
+ *     pointer to that frame is what the kernel stores in thread->psp.
+ *   - SIGALRM (setitimer) plays the SysTick role and calls s_tick_increase().
+ *   - The IRQ lock is a software PRIMASK: while it is set the SIGALRM handler
+ *     only latches a pending tick, which is replayed by s_irq_enable(). This
+ *     avoids a sigprocmask() system call on every kernel critical section.
+ *   - s_normal_switch_task() behaves like pending PendSV: the switch happens
+ *     immediately when interrupts are enabled, otherwise it is deferred until
+ *     the mask is dropped (s_irq_enable or tick handler exit).
+ *
+ *   The kernel passes PSP storage addresses as s_uint32_t which cannot hold a
+ *   host pointer, so the port ignores them and switches to s_current_thread
+ *   (already updated by the scheduler) instead.
+ *   Signal handlers run on the interrupted thread stack: thread stacks must be
+ *   a few KiB larger than on the target (see bsp/posix/StaRT_Config.h).
+ *
+ *   Tickless idle either really sleeps on a one-shot timer, or, with
+ *   s_posix_virtual_clock set, fast-forwards: the skipped ticks are credited
+ *   at once and the expiry tick is latched as pending, so long idle periods
+ *   simulate in no wall time.
+ */
+
+#define _GNU_SOURCE
+#include "start.h"
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+/**
+ * @brief Saved thread context placed at the top of each thread stack.
+ */
+typedef struct stack
+{
+    ucontext_t ctx;          /**< Machine context restored by swapcontext */
+    void     (*entry)(void); /**< Thread entry function */
+} s_stack, *s_pstack;
+
+/** Software PRIMASK: 1 = kernel critical section / ISR active. */
+static volatile sig_atomic_t s_posix_irq_masked;
+/** Tick arrived while masked; replayed on unmask. */
+static volatile sig_atomic_t s_posix_tick_pending;
+/** Context switch requested while masked (PendSV pending equivalent). */
+static volatile sig_atomic_t s_posix_switch_pending;
+/** Context of the thread currently executing on the CPU. */
+static s_pstack s_posix_running;
+
+/** Tick interrupts delivered so far (diagnostics, e.g. tickless savings). */
+volatile s_uint32_t s_posix_tick_count;
+/** 1: tickless idle fast-forwards a virtual clock instead of sleeping. */
+volatile int s_posix_virtual_clock;
+
+#define s_posix_barrier() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+/**
+ * @brief Switch to s_current_thread until no further switch is pending.
+ * @note Must be called with the virtual IRQ mask set.
+ */
+static void s_posix_dispatch(void)
+{
+    s_pstack prev;
+    s_pstack next;
+
+    while (s_posix_switch_pending)
+    {
+        s_posix_switch_pending = 0;
+        s_posix_barrier();
+
+        next = (s_pstack)s_current_thread->psp;
+        if (next == s_posix_running)
+            continue;
+
+        prev            = s_posix_running;
+        s_posix_running = next;
+        swapcontext(&prev->ctx, &next->ctx);
+        /* Resumed: the switching context left the mask set for us. */
+    }
+}
+
+/**
+ * @brief Emulated SysTick_Handler body (runs with the mask set).
+ */
+static void s_posix_tick_isr(void)
+{
+    s_posix_tick_count++;
+    s_tick_increase();
+}
+
+/**
+ * @brief SIGALRM handler: deliver or latch one tick.
+ */
+static void s_posix_signal_handler(int sig)
+{
+    (void)sig;
+
+    if (s_posix_irq_masked)
+    {
+        s_posix_tick_pending = 1;
+        return;
+    }
+    s_posix_irq_masked = 1;
+    s_posix_barrier();
+
+    s_posix_tick_isr();
+
+    s_irq_enable(0);
+}
+
+/**
+ * @brief Disable (virtual) interrupts.
+ * @return Previous mask state.
+ */
+s_uint32_t s_irq_disable(void)
+{
+    s_uint32_t level = (s_uint32_t)s_posix_irq_masked;
+    s_posix_irq_masked = 1;
+    s_posix_barrier();
+    return level;
+}
+
+/**
+ * @brief Restore (virtual) interrupts, replaying latched ticks and switches.
+ * @param disirq Mask state returned by s_irq_disable().
+ */
+void s_irq_enable(s_uint32_t disirq)
+{
+    if (disirq)
+        return;
+
+    for (;;)
+    {
+        if (s_posix_tick_pending)
+        {
+            s_posix_tick_pending = 0;
+            s_posix_barrier();
+            s_posix_tick_isr();
+        }
+        if (s_posix_switch_pending)
+            s_posix_dispatch();
+
+        s_posix_barrier();
+        s_posix_irq_masked = 0;
+        s_posix_barrier();
+
+        /* A tick latched just before unmasking must not be lost. */
+        if (!s_posix_tick_pending && !s_posix_switch_pending)
+            break;
+        s_posix_irq_masked = 1;
+        s_posix_barrier();
+    }
+}
+
+/**
+ * @brief First code executed by every thread (entered with the mask set).
+ */
+static void s_posix_thread_entry(void)
+{
+    s_irq_enable(0);
+
+    s_posix_running->entry();
+
+    s_thread_exit();
+}
+
+/**
+ * @brief Initialize thread context for first run.
+ * @param entry Thread entry function.
+ * @param stackaddr Stack top (high address end).
+ * @return Context frame pointer stored as thread PSP.
+ */
+s_uint8_t *s_stack_init(void *entry, s_uint8_t *stackaddr)
+{
+    s_pstack   pstack;
+    s_uint8_t *psp;
+
+    /* 16-byte align per System V ABI. */
+    psp = (s_uint8_t *)(((unsigned long)stackaddr) & ~((unsigned long)16 - 1));
+
+    /* Reserve space for the context frame at the top of the stack. */
+    psp -= START_ALIGN_UP(sizeof(s_stack), 16);
+    pstack = (s_pstack)psp;
+
+    getcontext(&pstack->ctx);
+    sigemptyset(&pstack->ctx.uc_sigmask);
+    pstack->entry = (void (*)(void))entry;
+
+    /*
+     * The kernel does not hand the stack base to the port; makecontext only
+     * derives the initial stack pointer from ss_sp + ss_size, so the frame
+     * itself marks the usable top of stack.
+     */
+    pstack->ctx.uc_stack.ss_sp   = psp;
+    pstack->ctx.uc_stack.ss_size = 0;
+    pstack->ctx.uc_link          = NULL;
+    makecontext(&pstack->ctx, s_posix_thread_entry, 0);
+
+    return psp;
+}
+
+/**
+ * @brief Request a context switch to s_current_thread.
+ * @param prev Unused on host (see file note).
+ * @param next Unused on host (see file note).
+ */
+void s_normal_switch_task(s_uint32_t prev, s_uint32_t next)
+{
+    (void)prev;
+    (void)next;
+
+    s_posix_switch_pending = 1;
+    s_posix_barrier();
+
+    /* Interrupts enabled: behave like PendSV taken right away. */
+    if (!s_posix_irq_masked)
+    {
+        s_posix_irq_masked = 1;
+        s_posix_barrier();
+        s_irq_enable(0);
+    }
+}
+
+/**
+ * @brief Program the tick timer: periodic at START_TICK, or one-shot.
+ * @param ticks 0 for periodic mode, else one-shot after ticks periods.
+ */
+static void s_posix_tick_program(s_uint32_t ticks)
+{
+    struct itimerval it;
+    s_uint64_t us = (s_uint64_t)(ticks ? ticks : 1) * (1000000 / START_TICK);
+
+    it.it_value.tv_sec     = (time_t)(us / 1000000);
+    it.it_value.tv_usec    = (suseconds_t)(us % 1000000);
+    it.it_interval.tv_sec  = 0;
+    it.it_interval.tv_usec = ticks ? 0 : 1000000 / START_TICK;
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+/**
+ * @brief Start the SysTick emulation and enter the first thread.
+ * @param next Unused on host (see file note).
+ */
+void s_first_switch_task(s_uint32_t next)
+{
+    struct sigaction sa;
+
+    (void)next;
+
+    s_posix_irq_masked = 1;
+    s_posix_running    = (s_pstack)s_current_thread->psp;
+
+    sa.sa_handler = s_posix_signal_handler;
+    sa.sa_flags   = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, NULL);
+
+    s_posix_tick_program(0);
+
+    setcontext(&s_posix_running->ctx);
+}
+
+#if START_USING_TICKLESS
+/* Longest real tickless sleep: 4 s, below the ~4.29 s wrap of s_cycle_get()
+ * so the runtime accounting on wakeup never loses a whole counter period. */
+#define S_POSIX_TICKLESS_MAX  (4UL * START_TICK)
+
+/**
+ * @brief Suppress the periodic tick for ticks periods (mask set by caller).
+ * @return Whole ticks elapsed, excluding the latched expiry tick.
+ */
+s_uint32_t s_cpu_tickless_sleep(s_uint32_t ticks)
+{
+    sigset_t alrm;
+    sigset_t prev;
+
+    /* A tick is already latched: the kernel view is stale, do not sleep. */
+    if (s_posix_tick_pending)
+        return 0;
+
+    if (s_posix_virtual_clock)
+    {
+        s_posix_tick_pending = 1;
+        return ticks - 1;
+    }
+
+    if (ticks > S_POSIX_TICKLESS_MAX)
+        ticks = S_POSIX_TICKLESS_MAX;
+
+    /* Block SIGALRM so it cannot slip in between arming and sigsuspend. */
+    sigemptyset(&alrm);
+    sigaddset(&alrm, SIGALRM);
+    sigprocmask(SIG_BLOCK, &alrm, &prev);
+
+    s_posix_tick_program(ticks);
+    while (!s_posix_tick_pending)
+        sigsuspend(&prev);
+    s_posix_tick_program(0);
+
+    sigprocmask(SIG_SETMASK, &prev, NULL);
+    return ticks - 1;
+}
+#endif
+
+/**
+ * @brief Monotonic clock needs no setup on host.
+ */
+void s_cycle_init(void)
+{
+}
+
+/**
+ * @brief Monotonic clock in nanoseconds (truncated, wraps every ~4.3 s).
+ * @note Tickless sleeps are capped at S_POSIX_TICKLESS_MAX to stay below it.
+ */
+s_uint32_t s_cycle_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (s_uint32_t)((s_uint64_t)ts.tv_sec * 1000000000ULL + (s_uint64_t)ts.tv_nsec);
+}
+
+#if START_USING_CPU_FFS
+int __s_ffs(int value)
+{
+    return __builtin_ffs(value);
+}
+#else
+/**
+ * @brief Generic fallback implementation of __s_ffs (first set bit).
+ */
+int __s_ffs(int value)
+{
+    if (value == 0) return 0;
+    int idx = 1;
+    while ((value & 1) == 0) { value >>= 1; ++idx; }
+    return idx;
+}
+#endif
@@ -35,7 +35,6 @@ __weak void s_start_banner(void)
 /* Idle thread objects (statically allocated) */
 static s_thread    idle_thread;
 static s_uint8_t   idle_stack[START_IDLE_STACK_SIZE];
-static volatile int idle_counter = 0;
 
 /**
  * @brief Idle thread entry: performs background cleanup & optional power saving.
@@ -47,8 +46,13 @@ static void idle_thread_entry(void)
         /* Reclaim defunct threads. */
         s_cleanup_defunct_threads();
 
+#if START_USING_TICKLESS
+        /* Suppress SysTick and sleep until the next timer expiry. */
+        s_tickless_idle();
+#else
         /* Optionally insert low-power instruction (WFI). */
         /* __asm volatile ("wfi"); */
+#endif
     }
 }
 
@@ -68,11 +72,46 @@ s_status s_idle_thread_init(void)
     return s_thread_startup(&idle_thread);
 }
 
+#if START_USING_RUNTIME_STATS
+extern s_uint64_t s_sched_runtime_total;
+
+/**
+ * @brief CPU load since the previous call, from idle thread runtime.
+ * @return Busy time in permille (0..1000).
+ */
+s_uint32_t s_system_load_get(void)
+{
+    static s_uint64_t last_total;
+    static s_uint64_t last_idle;
+    register s_uint32_t level;
+    s_uint64_t total;
+    s_uint64_t idle;
+
+    level = s_irq_disable();
+    s_sched_runtime_update();
+    total = s_sched_runtime_total - last_total;
+    idle  = idle_thread.runtime - last_idle;
+    last_total += total;
+    last_idle  += idle;
+    s_irq_enable(level);
+
+    if (total == 0)
+        return 0;
+    return 1000 - (s_uint32_t)(idle * 1000 / total);
+}
+#endif
+
 /**
  * @brief Initialize kernel core subsystems.
  */
 s_status s_start_init(void)
 {
+#if START_USING_RUNTIME_STATS || START_USING_TRACE
+    s_cycle_init();
+#endif
+#if START_USING_TRACE
+    s_trace_init();
+#endif
     s_sched_init();
     s_timer_list_init();
     s_idle_thread_init();
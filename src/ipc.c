@@ -1,6 +1,7 @@
 /**
  * @file ipc.c
- * @brief IPC primitives: semaphore, mutex, message queue and suspend helpers.
+ * @brief IPC primitives: semaphore, mutex, message queue, mailbox, event
+ *        flags and suspend helpers.
  * @version 1.0.2
  * @date 2025-08-26
  * @author
@@ -14,20 +15,228 @@
 
 #if START_USING_IPC
 
+#if START_IPC_WAIT_POOL < 0 || START_IPC_WAIT_POOL > 32
+#error "START_IPC_WAIT_POOL must be 0..32"
+#endif
+
+#if START_IPC_WAIT_POOL > 0
+#define S_WAITQ_POOL_MASK \
+    (START_IPC_WAIT_POOL == 32 ? 0xFFFFFFFFUL : (1UL << START_IPC_WAIT_POOL) - 1)
+
+/* Priority heads lent to PRIO wait queues; FIFO queues never take one. */
+static s_waitq_levels s_waitq_pool[START_IPC_WAIT_POOL];
+static s_uint32_t     s_waitq_pool_used;   /**< Bit n set: s_waitq_pool[n] is lent */
+
+/**
+ * @brief Check that q->prio is a pool slot lent to q (IRQ lock held).
+ * @note A queue initialized again without delete still owns its slot; a
+ *       fresh queue may hold any garbage in prio.
+ */
+s_inline s_uint8_t __s_waitq_owns(s_waitq *q)
+{
+    if (q->prio < s_waitq_pool || q->prio >= s_waitq_pool + START_IPC_WAIT_POOL)
+        return 0;
+    return (s_waitq_pool_used & (1UL << (q->prio - s_waitq_pool))) &&
+           q->prio->owner == q;
+}
+
+/**
+ * @brief First priority >= from whose bitmap bit is set.
+ * @return Priority, or START_THREAD_PRIORITY_MAX if there is none.
+ * @note Same two-level lookup as s_sched_highest_priority().
+ */
+static s_uint32_t __s_waitq_next(s_waitq_levels *lv, s_uint32_t from)
+{
+    s_uint32_t map;
+
+    if (from >= START_THREAD_PRIORITY_MAX)
+        return START_THREAD_PRIORITY_MAX;
+#if START_THREAD_PRIORITY_MAX > 32
+    register s_uint32_t number = from >> 5;
+
+    map = lv->table[number] & (0xFFFFFFFFUL << (from & 0x1F));
+    if (map == 0)
+    {
+        map = lv->group & ~((2UL << number) - 1);
+        if (map == 0)
+            return START_THREAD_PRIORITY_MAX;
+        number = __s_ffs((int)map) - 1;
+        map    = lv->table[number];
+    }
+    return (number << 5) + __s_ffs((int)map) - 1;
+#else
+    map = lv->group & (0xFFFFFFFFUL << from);
+    return map ? (s_uint32_t)__s_ffs((int)map) - 1 : START_THREAD_PRIORITY_MAX;
+#endif
+}
+
+/**
+ * @brief Clear the bitmap bit of an emptied priority (IRQ lock held).
+ */
+s_inline void __s_waitq_clear(s_waitq_levels *lv, s_uint32_t prio)
+{
+#if START_THREAD_PRIORITY_MAX > 32
+    lv->table[prio >> 5] &= ~(1UL << (prio & 0x1F));
+    if (lv->table[prio >> 5] == 0)
+        lv->group &= ~(1UL << (prio >> 5));
+#else
+    lv->group &= ~(1UL << prio);
+#endif
+}
+#endif
+
+/**
+ * @brief Initialize an empty wait queue.
+ * @param flag START_IPC_FLAG_PRIO borrows per-priority heads from the pool.
+ * @return S_OK, or S_ERR if a PRIO queue found the pool exhausted.
+ * @note Heads q still holds from an earlier init are returned first, so
+ *       initializing an object again without deleting it does not leak.
+ */
+s_status s_waitq_init(s_waitq *q, s_uint8_t flag)
+{
+#if START_IPC_WAIT_POOL > 0
+    register s_uint32_t level;
+    s_waitq_levels *lv = NULL;
+    s_uint32_t free;
+
+    s_list_init(&q->list);
+
+    level = s_irq_disable();
+    if (__s_waitq_owns(q))
+        s_waitq_pool_used &= ~(1UL << (q->prio - s_waitq_pool));
+    q->prio = NULL;
+    if (flag == START_IPC_FLAG_PRIO)
+    {
+        free = ~s_waitq_pool_used & S_WAITQ_POOL_MASK;
+        if (free == 0)
+        {
+            s_irq_enable(level);
+            return S_ERR;
+        }
+        lv = &s_waitq_pool[__s_ffs((int)free) - 1];
+        s_waitq_pool_used |= 1UL << (lv - s_waitq_pool);
+        lv->owner = q;
+        lv->group = 0;
+#if START_THREAD_PRIORITY_MAX > 32
+        for (int i = 0; i < (START_THREAD_PRIORITY_MAX + 31) / 32; i++)
+            lv->table[i] = 0;
+#endif
+    }
+    s_irq_enable(level);
+
+    if (lv != NULL)
+    {
+        for (int i = 0; i < START_THREAD_PRIORITY_MAX; i++)
+            s_list_init(&lv->level[i]);
+        q->prio = lv;
+    }
+#else
+    (void)flag;
+    s_list_init(&q->list);
+#endif
+    return S_OK;
+}
+
+/**
+ * @brief Initialize the two wait queues of an object: both or neither.
+ */
+static s_status __s_waitq_init_pair(s_waitq *a, s_waitq *b, s_uint8_t flag)
+{
+    if (s_waitq_init(a, flag) != S_OK)
+        return S_ERR;
+    if (s_waitq_init(b, flag) != S_OK)
+    {
+        s_waitq_deinit(a);
+        return S_ERR;
+    }
+    return S_OK;
+}
+
+/**
+ * @brief Return the priority heads of an emptied wait queue to the pool.
+ * @note Called by the delete functions after every waiter was resumed.
+ */
+void s_waitq_deinit(s_waitq *q)
+{
+#if START_IPC_WAIT_POOL > 0
+    register s_uint32_t level = s_irq_disable();
+
+    if (__s_waitq_owns(q))
+        s_waitq_pool_used &= ~(1UL << (q->prio - s_waitq_pool));
+    q->prio = NULL;
+    s_irq_enable(level);
+#else
+    (void)q;
+#endif
+}
+
+/**
+ * @brief Check whether any thread waits on q (does not modify q).
+ */
+s_uint8_t s_waitq_isempty(s_waitq *q)
+{
+#if START_IPC_WAIT_POOL > 0
+    if (q->prio != NULL)
+    {
+        for (s_uint32_t n = __s_waitq_next(q->prio, 0); n < START_THREAD_PRIORITY_MAX;
+             n = __s_waitq_next(q->prio, n + 1))
+        {
+            if (!s_list_isempty(&q->prio->level[n]))
+                return 0;
+        }
+    }
+#endif
+    return s_list_isempty(&q->list) ? 1 : 0;
+}
+
+/**
+ * @brief Thread to wake next: head of the most urgent non-empty priority,
+ *        else head of the plain list.
+ * @return Thread, or NULL if nobody waits.
+ * @note Call with the IRQ lock held. A priority emptied behind the bitmap's
+ *       back (timeout, s_list_delete of the waiter) is cleared here, so every
+ *       bit is cleared at most once per time it was set.
+ */
+s_pthread s_waitq_first(s_waitq *q)
+{
+#if START_IPC_WAIT_POOL > 0
+    s_uint32_t n;
+
+    if (q->prio != NULL)
+    {
+        while ((n = __s_waitq_next(q->prio, 0)) < START_THREAD_PRIORITY_MAX)
+        {
+            if (!s_list_isempty(&q->prio->level[n]))
+                return S_LIST_ENTRY(q->prio->level[n].next, s_thread, tlist);
+            __s_waitq_clear(q->prio, n);
+        }
+    }
+#endif
+    if (!s_list_isempty(&q->list))
+        return S_LIST_ENTRY(q->list.next, s_thread, tlist);
+    return NULL;
+}
+
 /**
- * @brief Suspend a thread into an IPC wait list (FIFO or PRIO).
- * @param list Suspend list head (sentinel).
+ * @brief Suspend a thread into an IPC wait queue (FIFO or PRIO).
+ * @param q Wait queue.
  * @param thread Thread to suspend.
  * @param flag START_IPC_FLAG_FIFO or START_IPC_FLAG_PRIO.
+ * @note FIFO appends to the plain list. PRIO appends to the head of the
+ *       thread priority and sets its bitmap bits: O(1). With
+ *       START_IPC_WAIT_POOL 0 a PRIO queue walks its sorted plain list.
  */
-s_status s_ipc_suspend(s_list *list, s_pthread thread, s_uint8_t flag)
+s_status s_ipc_suspend(s_waitq *q, s_pthread thread, s_uint8_t flag)
 {
     register s_uint32_t level;
-    s_plist p;
+    s_plist    head;
+    s_plist    p;
 
-    if (list == NULL || thread == NULL)
+    if (q == NULL || thread == NULL)
         return S_NULL;
 
+    S_TRACE(S_TRACE_EV_SUSPEND, q, thread->current_priority);
+
     /* enter critical */
     level = s_irq_disable();
 
@@ -35,57 +244,59 @@ s_status s_ipc_suspend(s_list *list, s_pthread thread, s_uint8_t flag)
     s_sched_remove_thread(thread);
     thread->status = START_THREAD_SUSPEND;
 
-    /* insert into suspend list according to flag */
-    switch (flag)
+#if START_IPC_WAIT_POOL > 0
+    if (flag == START_IPC_FLAG_PRIO && q->prio != NULL)
+    {
+        s_list_insert_before(&q->prio->level[thread->current_priority], &thread->tlist);
+#if START_THREAD_PRIORITY_MAX > 32
+        q->prio->table[thread->number] |= thread->high_mask;
+#endif
+        q->prio->group |= thread->number_mask;
+        s_irq_enable(level);
+        return S_OK;
+    }
+#endif
+    head = &q->list;
+    p    = head;
+
+    /* Append, unless the tail is less urgent: then go before the first such waiter. */
+    if (flag == START_IPC_FLAG_PRIO && !s_list_isempty(head) &&
+        S_LIST_ENTRY(head->prev, s_thread, tlist)->current_priority > thread->current_priority)
     {
-    case START_IPC_FLAG_FIFO:
-        s_list_insert_before(list, &thread->tlist);
-        break;
-    case START_IPC_FLAG_PRIO:/* PRIO (higher priority value -> lower priority number) */
-         p = list->next;
-        while (p != list)
+        for (p = head->next; p != head; p = p->next)
         {
-            s_pthread sth = S_LIST_ENTRY(p, s_thread, tlist);
-            if (thread->current_priority < sth->current_priority)
-            {
-                s_list_insert_before(&sth->tlist, &thread->tlist);
+            if (thread->current_priority < S_LIST_ENTRY(p, s_thread, tlist)->current_priority)
                 break;
-            }
-            p = p->next;
-        }
-        if (p == list)
-        {
-            /* not found position, append to end */
-            s_list_insert_before(list, &thread->tlist);
         }
-        break;
-    default:
-        /* Unsupported flag -> append FIFO style */
-        s_list_insert_before(list, &thread->tlist);
-        break;
     }
+    s_list_insert_before(p, &thread->tlist);
 
     s_irq_enable(level);
     return S_OK;
 }
 
 /**
- * @brief Resume all threads in given suspend list (no immediate schedule).
- * @param list Suspend list head.
+ * @brief Resume all threads in given wait queue (no immediate schedule).
+ * @param q Wait queue.
  * @note Caller may invoke s_sched_switch() if desired.
  */
-s_status s_ipc_list_resume_all(s_list *list)
+s_status s_ipc_list_resume_all(s_waitq *q)
 {
     register s_uint32_t level;
     s_pthread thread;
 
-    if (list == NULL)
+    if (q == NULL)
         return S_NULL;
 
-    while (!s_list_isempty(list))
+    while (1)
     {
         level = s_irq_disable();
-        thread = S_LIST_ENTRY(list->next, s_thread, tlist);
+        thread = s_waitq_first(q);
+        if (thread == NULL)
+        {
+            s_irq_enable(level);
+            break;
+        }
         s_list_delete(&thread->tlist);
         thread->status = START_THREAD_READY;
         s_sched_insert_thread(thread);
@@ -94,6 +305,56 @@ s_status s_ipc_list_resume_all(s_list *list)
     return S_OK;
 }
 
+#if START_USING_WAITSET
+/**
+ * @brief Wake a thread blocked on the wait set parent belongs to (IRQ lock held).
+ * @return 1 if a thread was woken.
+ */
+static s_uint8_t __s_waitset_notify(struct ipc_parent *parent)
+{
+    s_pthread thread;
+
+    if (parent->set == NULL)
+        return 0;
+
+    thread = s_waitq_first(&parent->set->parent.suspend_thread);
+    if (thread == NULL)
+        return 0;
+
+    s_list_delete(&thread->tlist);
+    thread->status = START_THREAD_READY;
+    s_sched_insert_thread(thread);
+    return 1;
+}
+
+/**
+ * @brief Drop a deleted object from its wait set.
+ */
+static void __s_waitset_detach(struct ipc_parent *parent)
+{
+    register s_uint32_t level = s_irq_disable();
+    s_pwaitset ws = parent->set;
+
+    if (ws != NULL)
+    {
+        for (s_uint8_t i = 0; i < ws->count; i++)
+        {
+            if (ws->member[i] != parent)
+                continue;
+            ws->count--;
+            for (; i < ws->count; i++)
+            {
+                ws->member[i] = ws->member[i + 1];
+                ws->type[i]   = ws->type[i + 1];
+            }
+            break;
+        }
+        parent->set = NULL;
+    }
+    s_irq_enable(level);
+}
+#endif
+
 #if START_USING_SEMAPHORE
 /**
  * @brief Initialize semaphore.
@@ -103,11 +364,15 @@ s_status s_sem_init(s_psem sem, s_uint16_t value, s_uint8_t flag)
     if (sem == NULL)
         return S_NULL;
 
-    s_list_init(&sem->parent.suspend_thread);
+    if (s_waitq_init(&sem->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
     sem->count          = value;
     sem->reserved       = 0;
     sem->parent.flag    = flag;
     sem->parent.status  = 1;
+#if START_USING_WAITSET
+    sem->parent.set     = NULL;
+#endif
     return S_OK;
 }
 
@@ -120,11 +385,15 @@ s_status s_sem_delete(s_psem sem)
     if (sem == NULL)
         return S_NULL;
 
-    if (!s_list_isempty(&sem->parent.suspend_thread))
+#if START_USING_WAITSET
+    __s_waitset_detach(&sem->parent);
+#endif
+    if (!s_waitq_isempty(&sem->parent.suspend_thread))
     {
         s_ipc_list_resume_all(&sem->parent.suspend_thread);
         need_schedule = 1;
     }
+    s_waitq_deinit(&sem->parent.suspend_thread);
 
     sem->count         = 0;
     sem->reserved      = 0;
@@ -163,7 +432,7 @@ s_status s_sem_take(s_psem sem, s_int32_t time)
         return S_ERR;
     }
 
-    thread = s_thread_get();
+    thread = s_thread_get_blockable();
     if (thread == NULL)
     {
         s_irq_enable(level);
@@ -180,6 +449,8 @@ s_status s_sem_take(s_psem sem, s_int32_t time)
 
     s_irq_enable(level);
     s_sched_switch();
+    /* Woken early: a stale timer would later pull us off another wait list. */
+    s_timer_stop(&(thread->timer));
 
     level = s_irq_disable();
     if (sem->count > 0)
@@ -206,8 +477,11 @@ s_status s_sem_release(s_psem sem)
     if (sem->parent.status == 0)
         return S_DELETED;
 
+    S_TRACE(S_TRACE_EV_SEM_RELEASE, sem, 0);
+
     level = s_irq_disable();
-    if (!s_list_isempty(&sem->parent.suspend_thread))
+    thread = s_waitq_first(&sem->parent.suspend_thread);
+    if (thread != NULL)
     {
         if (sem->count < SEM_VALUE_MAX)
             sem->count++;
@@ -217,7 +491,6 @@ s_status s_sem_release(s_psem sem)
             return S_ERR;
         }
 
-        thread = S_LIST_ENTRY(sem->parent.suspend_thread.next, s_thread, tlist);
         s_list_delete(&thread->tlist);
         thread->status = START_THREAD_READY;
         s_sched_insert_thread(thread);
@@ -232,6 +505,9 @@ s_status s_sem_release(s_psem sem)
             s_irq_enable(level);
             return S_ERR;
         }
+#if START_USING_WAITSET
+        need_schedule = __s_waitset_notify(&sem->parent);
+#endif
     }
     s_irq_enable(level);
 
@@ -241,7 +517,64 @@ s_status s_sem_release(s_psem sem)
 }
 #endif /* START_USING_SEMAPHORE */
 
+#if START_USING_MUTEX || START_USING_RWLOCK
+/**
+ * @brief Raise owner to waiter's priority if the waiter is more urgent (IRQ lock held).
+ * @param original Owner priority before the first boost, 0xFF until then.
+ */
+s_inline void __s_ipc_inherit(s_pthread owner, s_pthread waiter, s_uint8_t *original)
+{
+    if (owner && waiter->current_priority < owner->current_priority)
+    {
+        if (*original == 0xFF)
+            *original = owner->current_priority;
+        s_thread_ctrl(owner, START_THREAD_SET_PRIORITY, &waiter->current_priority);
+    }
+}
+
+/**
+ * @brief Drop an inherited priority when the owner lets go (IRQ lock held).
+ */
+s_inline void __s_ipc_restore(s_pthread owner, s_uint8_t original)
+{
+    if (original != 0xFF && owner->current_priority != original)
+        s_thread_ctrl(owner, START_THREAD_SET_PRIORITY, &original);
+}
+#endif
+
 #if START_USING_MUTEX
+/* Bit 0 of owner: threads may be queued, so the owner must release via the slow path. */
+#define S_MUTEX_WAITERS     ((size_t)1)
+#define S_MUTEX_OWNER(m)    ((s_pthread)((size_t)(m)->owner & ~S_MUTEX_WAITERS))
+
+#if START_MUTEX_FAST_PATH
+/**
+ * @brief Compare-and-swap the owner word without masking interrupts.
+ * @return 1 if owner was expect and is now desire.
+ * @note Cortex-M3: LDREX/STREX (GCC emits them for the builtin); any
+ *       exception between the two clears the monitor and the store retries.
+ *       Host: the same builtin is a locked compare-exchange.
+ */
+s_inline s_uint8_t __s_mutex_cas(s_pmutex m, s_pthread expect, s_pthread desire)
+{
+#if defined(__CC_ARM)
+    do
+    {
+        if ((s_pthread)__ldrex((volatile s_uint32_t *)&m->owner) != expect)
+        {
+            __clrex();
+            return 0;
+        }
+    } while (__strex((s_uint32_t)desire, (volatile s_uint32_t *)&m->owner));
+    __dmb(0xF);
+    return 1;
+#else
+    return __atomic_compare_exchange_n(&m->owner, &expect, desire, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+}
+#endif
+
 /**
  * @brief Initialize mutex (recursive + priority inheritance).
  */
@@ -249,7 +582,8 @@ s_status s_mutex_init(s_pmutex m, s_uint8_t flag)
 {
     if (m == NULL) return S_NULL;
 
-    s_list_init(&m->parent.suspend_thread);
+    if (s_waitq_init(&m->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
     m->parent.flag   = flag;
     m->parent.status = 1;
 
@@ -269,17 +603,15 @@ s_status s_mutex_delete(s_pmutex m)
     if (m == NULL) return S_NULL;
     if (m->parent.status == 0) return S_OK;
 
-    if (!s_list_isempty(&m->parent.suspend_thread))
+    if (!s_waitq_isempty(&m->parent.suspend_thread))
     {
         s_ipc_list_resume_all(&m->parent.suspend_thread);
         need_schedule = 1;
     }
+    s_waitq_deinit(&m->parent.suspend_thread);
 
-    if (m->owner && m->original_priority != 0xFF &&
-        m->owner->current_priority != m->original_priority)
-    {
-        s_thread_ctrl(m->owner, START_THREAD_SET_PRIORITY, &m->original_priority);
-    }
+    if (S_MUTEX_OWNER(m) != NULL)
+        __s_ipc_restore(S_MUTEX_OWNER(m), m->original_priority);
 
     m->owner             = NULL;
     m->count             = 0;
@@ -294,15 +626,31 @@ s_status s_mutex_delete(s_pmutex m)
 
 /**
  * @brief Acquire mutex (supports recursion and priority inheritance).
+ * @note With START_MUTEX_FAST_PATH a free mutex is taken with one
+ *       compare-and-swap on owner, without masking interrupts or touching
+ *       the wait queue.
  */
 s_status s_mutex_take(s_pmutex m, s_int32_t time)
 {
     register s_uint32_t level;
     s_pthread self;
+    s_pthread owner;
 
     if (m == NULL) return S_NULL;
     if (m->parent.status == 0) return S_DELETED;
 
+    S_TRACE(S_TRACE_EV_MUTEX_TAKE, m, 0);
+
+#if START_MUTEX_FAST_PATH
+    self = s_thread_get();
+    if (self != NULL && __s_mutex_cas(m, NULL, self))
+    {
+        m->hold  = 1;
+        m->count = 0;
+        return S_OK;
+    }
+#endif
+
     while (1)
     {
         level = s_irq_disable();
@@ -319,7 +667,8 @@ s_status s_mutex_take(s_pmutex m, s_int32_t time)
             return S_UNSUPPORTED;
         }
 
-        if (m->owner == self)
+        owner = S_MUTEX_OWNER(m);
+        if (owner == self)
         {
             if (m->hold < MUTEX_HOLD_MAX)
             {
@@ -331,12 +680,12 @@ s_status s_mutex_take(s_pmutex m, s_int32_t time)
             return S_ERR;
         }
 
-        if (m->count > 0)
+        if (owner == NULL)
         {
-            m->count--;
+            m->count             = 0;
             m->owner             = self;
             m->hold              = 1;
-            m->original_priority = self->current_priority;
+            m->original_priority = 0xFF;
             s_irq_enable(level);
             return S_OK;
         }
@@ -346,16 +695,16 @@ s_status s_mutex_take(s_pmutex m, s_int32_t time)
             s_irq_enable(level);
             return S_ERR;
         }
-
-        if (m->owner && self->current_priority < m->owner->current_priority)
+        if (s_sched_get_lock_nest())
         {
-            if (m->original_priority == 0xFF)
-                m->original_priority = m->owner->current_priority;
-            s_thread_ctrl(m->owner,
-                          START_THREAD_SET_PRIORITY,
-                          &self->current_priority);
+            s_irq_enable(level);
+            return S_UNSUPPORTED;
         }
 
+        /* Owner's fast release now fails its compare-and-swap. */
+        __s_ipc_inherit(owner, self, &m->original_priority);
+        m->owner = (s_pthread)((size_t)owner | S_MUTEX_WAITERS);
+
         s_ipc_suspend(&m->parent.suspend_thread, self, m->parent.flag);
 
         if (time > 0)
@@ -366,16 +715,17 @@ s_status s_mutex_take(s_pmutex m, s_int32_t time)
 
         s_irq_enable(level);
         s_sched_switch();
+        s_timer_stop(&self->timer);
 
         if (m->parent.status == 0)
             return S_DELETED;
-        if (m->owner == self)
+        if (S_MUTEX_OWNER(m) == self)
             return S_OK;
 
         if (time > 0)
         {
             level = s_irq_disable();
-            if (m->owner != self && m->count == 0)
+            if (S_MUTEX_OWNER(m) != self && m->count == 0)
             {
                 s_irq_enable(level);
                 return S_ERR;
@@ -385,6 +735,38 @@ s_status s_mutex_take(s_pmutex m, s_int32_t time)
     }
 }
 
+/**
+ * @brief Hand the mutex to the first waiter or free it (IRQ lock held, hold == 0).
+ * @return 1 if a waiter became owner.
+ */
+static s_uint8_t __s_mutex_unlock(s_pmutex m, s_pthread self)
+{
+    s_pthread th = s_waitq_first(&m->parent.suspend_thread);
+
+    __s_ipc_restore(self, m->original_priority);
+    if (th != NULL)
+    {
+        s_list_delete(&th->tlist);
+
+        m->owner             = th;
+        m->hold              = 1;
+        m->count             = 0;
+        m->original_priority = 0xFF;
+        if (!s_waitq_isempty(&m->parent.suspend_thread))
+            m->owner = (s_pthread)((size_t)th | S_MUTEX_WAITERS);
+
+        th->status = START_THREAD_READY;
+        s_sched_insert_thread(th);
+        return 1;
+    }
+
+    m->owner             = NULL;
+    m->original_priority = 0xFF;
+    if (m->count < 1)
+        m->count++;
+    return 0;
+}
+
 /**
  * @brief Release mutex (handover or free, restore priority if needed).
  */
@@ -397,9 +779,24 @@ s_status s_mutex_release(s_pmutex m)
     if (m == NULL) return S_NULL;
     if (m->parent.status == 0) return S_DELETED;
 
-    level = s_irq_disable();
+    S_TRACE(S_TRACE_EV_MUTEX_RELEASE, m, 0);
+
     self = s_thread_get();
-    if (self != m->owner)
+#if START_MUTEX_FAST_PATH
+    /* Last hold, never boosted, nobody queued: one compare-and-swap frees it. */
+    if (m->owner == self && m->hold == 1 && m->original_priority == 0xFF)
+    {
+        m->hold  = 0;
+        m->count = 1;
+        if (__s_mutex_cas(m, self, NULL))
+            return S_OK;
+        m->hold  = 1;
+        m->count = 0;
+    }
+#endif
+
+    level = s_irq_disable();
+    if (self != S_MUTEX_OWNER(m))
     {
         s_irq_enable(level);
         return S_ERR;
@@ -414,39 +811,7 @@ s_status s_mutex_release(s_pmutex m)
         return S_OK;
     }
 
-    if (!s_list_isempty(&m->parent.suspend_thread))
-    {
-        s_pthread th = S_LIST_ENTRY(m->parent.suspend_thread.next, s_thread, tlist);
-        s_list_delete(&th->tlist);
-
-        if (m->original_priority != 0xFF &&
-            self->current_priority != m->original_priority)
-        {
-            s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &m->original_priority);
-        }
-
-        m->owner             = th;
-        m->hold              = 1;
-        m->count             = 0;
-        m->original_priority = th->current_priority;
-
-        th->status = START_THREAD_READY;
-        s_sched_insert_thread(th);
-        need_schedule = 1;
-    }
-    else
-    {
-        if (m->original_priority != 0xFF &&
-            self->current_priority != m->original_priority)
-        {
-            s_thread_ctrl(self, START_THREAD_SET_PRIORITY, &m->original_priority);
-        }
-        m->owner             = NULL;
-        m->original_priority = 0xFF;
-        if (m->count < 1)
-            m->count++;
-    }
-
+    need_schedule = __s_mutex_unlock(m, self);
     s_irq_enable(level);
 
     if (need_schedule)
@@ -455,78 +820,279 @@ s_status s_mutex_release(s_pmutex m)
 }
 #endif /* START_USING_MUTEX */
 
-#if START_USING_MESSAGEQUEUE
+#if START_USING_MUTEX && START_USING_COND
 /**
- * @brief Initialize message queue with external memory pool.
+ * @brief Take a waiter off the condition (IRQ lock held).
+ * @return 1 if it was made ready, 0 if it was queued on the busy mutex.
+ * @note Wait morphing: while the mutex is held the waiter could only block
+ *       on it again, so it moves straight onto the mutex queue and is woken
+ *       once, by the release that hands it the mutex.
  */
-s_status s_msgqueue_init(s_pmsgqueue mq,
-                         void *msg_pool,
-                         s_uint16_t msg_size,
-                         s_uint16_t pool_size,
-                         s_uint8_t flag)
+static s_uint8_t __s_cond_move(s_pcond cond, s_pthread th)
 {
-    if (mq == NULL || msg_pool == NULL)
-        return S_NULL;
-    if (msg_size == 0 || pool_size == 0)
-        return S_INVALID;
-
-    s_uint16_t align        = sizeof(s_uint32_t);
-    s_uint16_t aligned_size = (s_uint16_t)((msg_size + (align - 1)) & ~(align - 1));
-    s_uint16_t header_size  = (s_uint16_t)sizeof(struct s_mq_message);
+    s_pmutex m = cond->mutex;
 
-    if (pool_size < (header_size + aligned_size))
-        return S_INVALID;
-
-    s_uint16_t max_msgs = (s_uint16_t)(pool_size / (header_size + aligned_size));
-    if (max_msgs == 0)
-        return S_INVALID;
+    s_timer_stop(&th->timer);
+    s_list_delete(&th->tlist);
 
-    mq->parent.flag   = flag;
-    mq->parent.status = 1;
+    if (m != NULL && m->parent.status && S_MUTEX_OWNER(m) != NULL)
+    {
+        __s_ipc_inherit(S_MUTEX_OWNER(m), th, &m->original_priority);
+        m->owner = (s_pthread)((size_t)m->owner | S_MUTEX_WAITERS);
+        s_ipc_suspend(&m->parent.suspend_thread, th, m->parent.flag);
+        return 0;
+    }
 
-    s_list_init(&mq->parent.suspend_thread);
-    s_list_init(&mq->suspend_sender_thread);
+    th->status = START_THREAD_READY;
+    s_sched_insert_thread(th);
+    return 1;
+}
 
-    mq->msg_pool       = msg_pool;
-    mq->msg_size       = aligned_size;
-    mq->max_msgs       = max_msgs;
-    mq->index          = 0;
-    mq->msg_queue_head = NULL;
-    mq->msg_queue_tail = NULL;
-    mq->msg_queue_free = NULL;
+/**
+ * @brief Initialize condition variable.
+ */
+s_status s_cond_init(s_pcond cond, s_uint8_t flag)
+{
+    if (cond == NULL)
+        return S_NULL;
 
-    /* Build single-linked free list. */
-    s_uint8_t *base = (s_uint8_t *)msg_pool;
-    for (s_uint16_t i = 0; i < max_msgs; i++)
-    {
-        struct s_mq_message *node =
-            (struct s_mq_message *)(base + i * (header_size + aligned_size));
-        node->next       = (struct s_mq_message *)mq->msg_queue_free;
-        mq->msg_queue_free = node;
-    }
+    if (s_waitq_init(&cond->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
+    cond->mutex         = NULL;
+    cond->parent.flag   = flag;
+    cond->parent.status = 1;
     return S_OK;
 }
 
 /**
- * @brief Delete message queue (resume all waiters and clear internal fields).
+ * @brief Delete condition: waiters reacquire their mutex and return S_DELETED.
  */
-s_status s_msgqueue_delete(s_pmsgqueue mq)
+s_status s_cond_delete(s_pcond cond)
 {
     s_uint8_t need_schedule = 0;
 
-    if (mq == NULL)
+    if (cond == NULL)
         return S_NULL;
 
-    if (!s_list_isempty(&mq->parent.suspend_thread))
-    {
-        s_ipc_list_resume_all(&mq->parent.suspend_thread);
-        need_schedule = 1;
-    }
-    if (!s_list_isempty(&mq->suspend_sender_thread))
+    cond->parent.status = 0;
+    if (!s_waitq_isempty(&cond->parent.suspend_thread))
     {
-        s_ipc_list_resume_all(&mq->suspend_sender_thread);
+        s_ipc_list_resume_all(&cond->parent.suspend_thread);
         need_schedule = 1;
     }
+    s_waitq_deinit(&cond->parent.suspend_thread);
+    cond->parent.flag = 0;
+    cond->mutex       = NULL;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Release mutex and block on cond atomically, reacquire mutex on wake.
+ * @param mutex Held by the caller (recursion depth is restored on return).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT, S_DELETED, S_ERR (caller does not own mutex).
+ * @note The mutex is held again on every return except S_ERR and a deleted
+ *       mutex. Wakeups may be spurious: re-check the predicate in a loop.
+ *       All threads waiting on one condition must use the same mutex.
+ */
+s_status s_cond_wait(s_pcond cond, s_pmutex mutex, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint8_t  hold;
+    s_pthread  self;
+    s_status   ret = S_OK;
+
+    if (cond == NULL || mutex == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    if (cond->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+    self = s_thread_get();
+    if (self == NULL || S_MUTEX_OWNER(mutex) != self)
+    {
+        s_irq_enable(level);
+        return S_ERR;
+    }
+    if (timeout == 0)
+    {
+        s_irq_enable(level);
+        return S_TIMEOUT;
+    }
+    if (s_sched_get_lock_nest())
+    {
+        s_irq_enable(level);
+        return S_UNSUPPORTED;
+    }
+
+    /* Queue on cond before the mutex is let go: no signal can slip in between. */
+    cond->mutex = mutex;
+    s_ipc_suspend(&cond->parent.suspend_thread, self, cond->parent.flag);
+    if (timeout > 0)
+    {
+        start_tick = s_tick_get();
+        s_timer_ctrl(&self->timer, START_TIMER_SET_TIME, &timeout);
+        s_timer_start(&self->timer);
+    }
+
+    hold        = mutex->hold;
+    mutex->hold = 0;
+    __s_mutex_unlock(mutex, self);
+    s_irq_enable(level);
+
+    s_sched_switch();
+    s_timer_stop(&self->timer);
+
+    if (timeout > 0 && (s_int32_t)(s_tick_get() - start_tick) >= timeout)
+        ret = S_TIMEOUT;
+
+    /* A signal on a busy mutex already queued us there; the release handed it over. */
+    if (S_MUTEX_OWNER(mutex) != self && s_mutex_take(mutex, START_WAITING_FOREVER) != S_OK)
+        return S_DELETED;
+    mutex->hold = hold;
+
+    if (cond->parent.status == 0)
+        return S_DELETED;
+    return ret;
+}
+
+/**
+ * @brief Wake the first waiter.
+ */
+s_status s_cond_signal(s_pcond cond)
+{
+    register s_uint32_t level;
+    s_uint8_t need_schedule = 0;
+    s_pthread th;
+
+    if (cond == NULL)
+        return S_NULL;
+    if (cond->parent.status == 0)
+        return S_DELETED;
+
+    level = s_irq_disable();
+    th = s_waitq_first(&cond->parent.suspend_thread);
+    if (th != NULL)
+        need_schedule = __s_cond_move(cond, th);
+    s_irq_enable(level);
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Wake every waiter in one critical section, reschedule once.
+ */
+s_status s_cond_broadcast(s_pcond cond)
+{
+    register s_uint32_t level;
+    s_uint8_t need_schedule = 0;
+    s_pthread th;
+
+    if (cond == NULL)
+        return S_NULL;
+    if (cond->parent.status == 0)
+        return S_DELETED;
+
+    level = s_irq_disable();
+    while ((th = s_waitq_first(&cond->parent.suspend_thread)) != NULL)
+        need_schedule |= __s_cond_move(cond, th);
+    s_irq_enable(level);
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+#endif /* START_USING_MUTEX && START_USING_COND */
+
+#if START_USING_MESSAGEQUEUE
+/**
+ * @brief Initialize message queue with external memory pool.
+ */
+s_status s_msgqueue_init(s_pmsgqueue mq,
+                         void *msg_pool,
+                         s_uint16_t msg_size,
+                         s_uint16_t pool_size,
+                         s_uint8_t flag)
+{
+    if (mq == NULL || msg_pool == NULL)
+        return S_NULL;
+    if (msg_size == 0 || pool_size == 0)
+        return S_INVALID;
+
+    s_uint16_t align        = sizeof(s_uint32_t);
+    s_uint16_t aligned_size = (s_uint16_t)((msg_size + (align - 1)) & ~(align - 1));
+    s_uint16_t header_size  = (s_uint16_t)sizeof(struct s_mq_message);
+
+    if (pool_size < (header_size + aligned_size))
+        return S_INVALID;
+
+    s_uint16_t max_msgs = (s_uint16_t)(pool_size / (header_size + aligned_size));
+    if (max_msgs == 0)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&mq->parent.suspend_thread, &mq->suspend_sender_thread, flag) != S_OK)
+        return S_ERR;
+
+    mq->parent.flag   = flag;
+    mq->parent.status = 1;
+
+    mq->msg_pool       = msg_pool;
+    mq->msg_size       = aligned_size;
+    mq->max_msgs       = max_msgs;
+    mq->index          = 0;
+    mq->msg_queue_head = NULL;
+    mq->msg_queue_tail = NULL;
+    mq->msg_queue_free = NULL;
+#if START_USING_WAITSET
+    mq->parent.set     = NULL;
+#endif
+
+    /* Build single-linked free list. */
+    s_uint8_t *base = (s_uint8_t *)msg_pool;
+    for (s_uint16_t i = 0; i < max_msgs; i++)
+    {
+        struct s_mq_message *node =
+            (struct s_mq_message *)(base + i * (header_size + aligned_size));
+        node->next       = (struct s_mq_message *)mq->msg_queue_free;
+        mq->msg_queue_free = node;
+    }
+    return S_OK;
+}
+
+/**
+ * @brief Delete message queue (resume all waiters and clear internal fields).
+ */
+s_status s_msgqueue_delete(s_pmsgqueue mq)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (mq == NULL)
+        return S_NULL;
+
+#if START_USING_WAITSET
+    __s_waitset_detach(&mq->parent);
+#endif
+    if (!s_waitq_isempty(&mq->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&mq->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&mq->suspend_sender_thread))
+    {
+        s_ipc_list_resume_all(&mq->suspend_sender_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&mq->parent.suspend_thread);
+    s_waitq_deinit(&mq->suspend_sender_thread);
 
     mq->msg_queue_head = NULL;
     mq->msg_queue_tail = NULL;
@@ -544,32 +1110,19 @@ s_status s_msgqueue_delete(s_pmsgqueue mq)
     return S_OK;
 }
 
-/* Internal copy helper */
-static void __s_msg_copy_out(s_uint8_t *dst, const s_uint8_t *src, s_uint16_t len)
-{
-    while (len--) *dst++ = *src++;
-}
-
 /**
- * @brief Send message with optional blocking when full.
+ * @brief Take a free pool node, blocking on the sender list while full.
+ * @param node Receives the node (owned by the caller until put / freed).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
  */
-s_status s_msgqueue_send_wait(s_pmsgqueue mq,
-                              const void *buffer,
-                              s_uint16_t size,
-                              s_int32_t timeout)
+static s_status __s_mq_node_get(s_pmsgqueue mq,
+                                struct s_mq_message **node,
+                                s_int32_t timeout)
 {
     register s_uint32_t level;
-    struct s_mq_message *node;
     s_pthread thread;
     s_uint32_t start_tick = 0;
 
-    if (mq == NULL || buffer == NULL)
-        return S_NULL;
-    if (mq->parent.status == 0)
-        return S_DELETED;
-    if (size == 0 || size > mq->msg_size)
-        return S_INVALID;
-
     while (1)
     {
         level = s_irq_disable();
@@ -581,34 +1134,9 @@ s_status s_msgqueue_send_wait(s_pmsgqueue mq,
 
         if (mq->msg_queue_free != NULL)
         {
-            node = (struct s_mq_message *)mq->msg_queue_free;
-            mq->msg_queue_free = node->next;
+            *node = (struct s_mq_message *)mq->msg_queue_free;
+            mq->msg_queue_free = (*node)->next;
             s_irq_enable(level);
-
-            __s_msg_copy_out((s_uint8_t *)(node + 1), (const s_uint8_t *)buffer, size);
-
-            level = s_irq_disable();
-            node->next = NULL;
-            if (mq->msg_queue_tail)
-                ((struct s_mq_message *)mq->msg_queue_tail)->next = node;
-            mq->msg_queue_tail = node;
-            if (mq->msg_queue_head == NULL)
-                mq->msg_queue_head = node;
-            mq->index++;
-
-            if (!s_list_isempty(&mq->parent.suspend_thread))
-            {
-                s_pthread rth = S_LIST_ENTRY(mq->parent.suspend_thread.next, s_thread, tlist);
-                s_list_delete(&rth->tlist);
-                rth->status = START_THREAD_READY;
-                s_sched_insert_thread(rth);
-                s_irq_enable(level);
-                s_sched_switch();
-            }
-            else
-            {
-                s_irq_enable(level);
-            }
             return S_OK;
         }
 
@@ -618,7 +1146,7 @@ s_status s_msgqueue_send_wait(s_pmsgqueue mq,
             return S_ERR;
         }
 
-        thread = s_thread_get();
+        thread = s_thread_get_blockable();
         if (thread == NULL)
         {
             s_irq_enable(level);
@@ -637,6 +1165,7 @@ s_status s_msgqueue_send_wait(s_pmsgqueue mq,
 
         s_irq_enable(level);
         s_sched_switch();
+        s_timer_stop(&thread->timer);
 
         if (mq->parent.status == 0)
             return S_DELETED;
@@ -654,86 +1183,69 @@ s_status s_msgqueue_send_wait(s_pmsgqueue mq,
 }
 
 /**
- * @brief Non-blocking send wrapper.
- */
-s_status s_msgqueue_send(s_pmsgqueue mq,
-                         const void *buffer,
-                         s_uint16_t size)
-{
-    return s_msgqueue_send_wait(mq, buffer, size, 0);
-}
-
-/**
- * @brief Urgent send (insert at head, non-blocking).
+ * @brief Queue a filled node (tail, or head when urgent) and wake a receiver.
  */
-s_status s_msgqueue_urgent(s_pmsgqueue mq,
-                           const void *buffer,
-                           s_uint16_t size)
+static void __s_mq_node_put(s_pmsgqueue mq, struct s_mq_message *node, s_uint8_t urgent)
 {
     register s_uint32_t level;
-    struct s_mq_message *node;
 
-    if (mq == NULL || buffer == NULL)
-        return S_NULL;
-    if (mq->parent.status == 0)
-        return S_DELETED;
-    if (size == 0 || size > mq->msg_size)
-        return S_INVALID;
+    S_TRACE(S_TRACE_EV_MQ_SEND, mq, urgent);
 
     level = s_irq_disable();
-    if (mq->msg_queue_free == NULL)
+    if (urgent)
     {
-        s_irq_enable(level);
-        return S_ERR; /* 满 */
+        node->next         = (struct s_mq_message *)mq->msg_queue_head;
+        mq->msg_queue_head = node;
+        if (mq->msg_queue_tail == NULL)
+            mq->msg_queue_tail = node;
     }
-    node = (struct s_mq_message *)mq->msg_queue_free;
-    mq->msg_queue_free = node->next;
-    s_irq_enable(level);
-
-    __s_msg_copy_out((s_uint8_t *)(node + 1), (const s_uint8_t *)buffer, size);
-
-    level = s_irq_disable();
-    node->next        = (struct s_mq_message *)mq->msg_queue_head;
-    mq->msg_queue_head = node;
-    if (mq->msg_queue_tail == NULL)
+    else
+    {
+        node->next = NULL;
+        if (mq->msg_queue_tail)
+            ((struct s_mq_message *)mq->msg_queue_tail)->next = node;
         mq->msg_queue_tail = node;
+        if (mq->msg_queue_head == NULL)
+            mq->msg_queue_head = node;
+    }
     mq->index++;
 
-    if (!s_list_isempty(&mq->parent.suspend_thread))
+    s_pthread rth = s_waitq_first(&mq->parent.suspend_thread);
+    if (rth != NULL)
     {
-        s_pthread rth = S_LIST_ENTRY(mq->parent.suspend_thread.next, s_thread, tlist);
         s_list_delete(&rth->tlist);
         rth->status = START_THREAD_READY;
         s_sched_insert_thread(rth);
         s_irq_enable(level);
         s_sched_switch();
     }
+#if START_USING_WAITSET
+    else if (__s_waitset_notify(&mq->parent))
+    {
+        s_irq_enable(level);
+        s_sched_switch();
+    }
+#endif
     else
     {
         s_irq_enable(level);
     }
-    return S_OK;
 }
 
 /**
- * @brief Receive message with optional blocking.
+ * @brief Dequeue the oldest node, blocking on the receiver list while empty.
+ * @param node Receives the node (owned by the caller until freed).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
  */
-s_status s_msgqueue_recv(s_pmsgqueue mq,
-                         void *buffer,
-                         s_uint16_t size,
-                         s_int32_t timeout)
+static s_status __s_mq_node_take(s_pmsgqueue mq,
+                                 struct s_mq_message **node,
+                                 s_int32_t timeout)
 {
     register s_uint32_t level;
-    struct s_mq_message *node;
     s_pthread thread;
     s_uint32_t start_tick = 0;
 
-    if (mq == NULL || buffer == NULL)
-        return S_NULL;
-    if (mq->parent.status == 0)
-        return S_DELETED;
-    if (size == 0)
-        return S_INVALID;
+    S_TRACE(S_TRACE_EV_MQ_RECV, mq, 0);
 
     while (1)
     {
@@ -746,33 +1258,12 @@ s_status s_msgqueue_recv(s_pmsgqueue mq,
 
         if (mq->msg_queue_head != NULL && mq->index > 0)
         {
-            node = (struct s_mq_message *)mq->msg_queue_head;
-            mq->msg_queue_head = node->next;
-            if (mq->msg_queue_tail == node)
+            *node = (struct s_mq_message *)mq->msg_queue_head;
+            mq->msg_queue_head = (*node)->next;
+            if (mq->msg_queue_tail == *node)
                 mq->msg_queue_tail = NULL;
             mq->index--;
             s_irq_enable(level);
-
-            s_uint16_t copy_len = size > mq->msg_size ? mq->msg_size : size;
-            __s_msg_copy_out((s_uint8_t *)buffer, (s_uint8_t *)(node + 1), copy_len);
-
-            level = s_irq_disable();
-            node->next        = (struct s_mq_message *)mq->msg_queue_free;
-            mq->msg_queue_free = node;
-
-            if (!s_list_isempty(&mq->suspend_sender_thread))
-            {
-                s_pthread sth = S_LIST_ENTRY(mq->suspend_sender_thread.next, s_thread, tlist);
-                s_list_delete(&sth->tlist);
-                sth->status = START_THREAD_READY;
-                s_sched_insert_thread(sth);
-                s_irq_enable(level);
-                s_sched_switch();
-            }
-            else
-            {
-                s_irq_enable(level);
-            }
             return S_OK;
         }
 
@@ -782,7 +1273,7 @@ s_status s_msgqueue_recv(s_pmsgqueue mq,
             return S_ERR;
         }
 
-        thread = s_thread_get();
+        thread = s_thread_get_blockable();
         if (thread == NULL)
         {
             s_irq_enable(level);
@@ -800,6 +1291,7 @@ s_status s_msgqueue_recv(s_pmsgqueue mq,
 
         s_irq_enable(level);
         s_sched_switch();
+        s_timer_stop(&thread->timer);
 
         if (mq->parent.status == 0)
             return S_DELETED;
@@ -815,6 +1307,2122 @@ s_status s_msgqueue_recv(s_pmsgqueue mq,
         }
     }
 }
-#endif /* START_USING_MESSAGEQUEUE */
+
+/**
+ * @brief Return a node to the free list and wake a blocked sender.
+ */
+static void __s_mq_node_free(s_pmsgqueue mq, struct s_mq_message *node)
+{
+    register s_uint32_t level = s_irq_disable();
+
+    node->next         = (struct s_mq_message *)mq->msg_queue_free;
+    mq->msg_queue_free = node;
+
+    s_pthread sth = s_waitq_first(&mq->suspend_sender_thread);
+    if (sth != NULL)
+    {
+        s_list_delete(&sth->tlist);
+        sth->status = START_THREAD_READY;
+        s_sched_insert_thread(sth);
+        s_irq_enable(level);
+        s_sched_switch();
+    }
+    else
+    {
+        s_irq_enable(level);
+    }
+}
+
+/**
+ * @brief Send message with optional blocking when full.
+ */
+s_status s_msgqueue_send_wait(s_pmsgqueue mq,
+                              const void *buffer,
+                              s_uint16_t size,
+                              s_int32_t timeout)
+{
+    struct s_mq_message *node;
+    s_status ret;
+
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+    if (size == 0 || size > mq->msg_size)
+        return S_INVALID;
+
+    ret = __s_mq_node_get(mq, &node, timeout);
+    if (ret != S_OK)
+        return ret;
+
+    s_memcpy(node + 1, buffer, size);
+    __s_mq_node_put(mq, node, 0);
+    return S_OK;
+}
+
+/**
+ * @brief Non-blocking send wrapper.
+ */
+s_status s_msgqueue_send(s_pmsgqueue mq,
+                         const void *buffer,
+                         s_uint16_t size)
+{
+    return s_msgqueue_send_wait(mq, buffer, size, 0);
+}
+
+/**
+ * @brief Urgent send (insert at head, non-blocking).
+ */
+s_status s_msgqueue_urgent(s_pmsgqueue mq,
+                           const void *buffer,
+                           s_uint16_t size)
+{
+    struct s_mq_message *node;
+    s_status ret;
+
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+    if (size == 0 || size > mq->msg_size)
+        return S_INVALID;
+
+    ret = __s_mq_node_get(mq, &node, 0);
+    if (ret != S_OK)
+        return ret; /* 满 */
+
+    s_memcpy(node + 1, buffer, size);
+    __s_mq_node_put(mq, node, 1);
+    return S_OK;
+}
+
+/**
+ * @brief Receive message with optional blocking.
+ */
+s_status s_msgqueue_recv(s_pmsgqueue mq,
+                         void *buffer,
+                         s_uint16_t size,
+                         s_int32_t timeout)
+{
+    struct s_mq_message *node;
+    s_status ret;
+
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+    if (size == 0)
+        return S_INVALID;
+
+    ret = __s_mq_node_take(mq, &node, timeout);
+    if (ret != S_OK)
+        return ret;
+
+    s_uint16_t copy_len = size > mq->msg_size ? mq->msg_size : size;
+    s_memcpy(buffer, node + 1, copy_len);
+    __s_mq_node_free(mq, node);
+    return S_OK;
+}
+
+/**
+ * @brief Zero-copy send, step 1: reserve a pool slot to fill in place.
+ * @param buffer Receives the slot payload address (msg_size bytes).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @note Pass the slot to s_msgqueue_commit(), or s_msgqueue_release() to
+ *       drop it unsent.
+ */
+s_status s_msgqueue_alloc(s_pmsgqueue mq, void **buffer, s_int32_t timeout)
+{
+    struct s_mq_message *node;
+    s_status ret;
+
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+
+    ret = __s_mq_node_get(mq, &node, timeout);
+    if (ret != S_OK)
+        return ret;
+
+    *buffer = node + 1;
+    return S_OK;
+}
+
+/**
+ * @brief Zero-copy send, step 2: queue a slot filled after s_msgqueue_alloc().
+ */
+s_status s_msgqueue_commit(s_pmsgqueue mq, void *buffer)
+{
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+
+    __s_mq_node_put(mq, (struct s_mq_message *)buffer - 1, 0);
+    return S_OK;
+}
+
+/**
+ * @brief Zero-copy receive: borrow the oldest message in place.
+ * @param buffer Receives the payload address (valid until released).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ */
+s_status s_msgqueue_recv_ptr(s_pmsgqueue mq, void **buffer, s_int32_t timeout)
+{
+    struct s_mq_message *node;
+    s_status ret;
+
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+
+    ret = __s_mq_node_take(mq, &node, timeout);
+    if (ret != S_OK)
+        return ret;
+
+    *buffer = node + 1;
+    return S_OK;
+}
+
+/**
+ * @brief Return a slot from s_msgqueue_recv_ptr() (or an uncommitted
+ *        s_msgqueue_alloc()) to the pool.
+ */
+s_status s_msgqueue_release(s_pmsgqueue mq, void *buffer)
+{
+    if (mq == NULL || buffer == NULL)
+        return S_NULL;
+    if (mq->parent.status == 0)
+        return S_DELETED;
+
+    __s_mq_node_free(mq, (struct s_mq_message *)buffer - 1);
+    return S_OK;
+}
+
+#endif /* START_USING_MESSAGEQUEUE */
+
+#if START_USING_MAILBOX || START_USING_STREAM || START_USING_VMSGQUEUE || START_USING_PRIOQUEUE || \
+    START_USING_RWLOCK || START_USING_WAITSET
+/**
+ * @brief Make the first thread of a wait queue ready (IRQ lock held).
+ * @return 1 if a thread was woken.
+ */
+s_inline s_uint8_t __s_ipc_wake_one(s_waitq *q)
+{
+    s_pthread thread = s_waitq_first(q);
+
+    if (thread == NULL)
+        return 0;
+
+    s_list_delete(&thread->tlist);
+    thread->status = START_THREAD_READY;
+    s_sched_insert_thread(thread);
+    return 1;
+}
+
+/**
+ * @brief Suspend the current thread on q for up to timeout ticks.
+ * @param start_tick In/out: tick of the first suspend, used to shrink timeout.
+ * @return S_OK to retry, S_TIMEOUT, S_DELETED or S_UNSUPPORTED.
+ * @note Entered with the IRQ lock held (level), returns with it released.
+ */
+static s_status __s_ipc_wait(struct ipc_parent *parent, s_waitq *q, s_uint32_t level,
+                             s_int32_t *timeout, s_uint32_t *start_tick)
+{
+    s_pthread thread;
+
+    if (*timeout == 0)
+    {
+        s_irq_enable(level);
+        return S_TIMEOUT;
+    }
+
+    thread = s_thread_get_blockable();
+    if (thread == NULL)
+    {
+        s_irq_enable(level);
+        return S_UNSUPPORTED;
+    }
+
+    s_ipc_suspend(q, thread, parent->flag);
+    if (*timeout > 0)
+    {
+        if (*start_tick == 0)
+            *start_tick = s_tick_get();
+        s_timer_ctrl(&thread->timer, START_TIMER_SET_TIME, timeout);
+        s_timer_start(&thread->timer);
+    }
+
+    s_irq_enable(level);
+    s_sched_switch();
+    s_timer_stop(&thread->timer);
+
+    if (parent->status == 0)
+        return S_DELETED;
+
+    if (*timeout > 0)
+    {
+        s_uint32_t now     = s_tick_get();
+        s_uint32_t elapsed = now - *start_tick;
+        if ((s_int32_t)elapsed >= *timeout)
+            return S_TIMEOUT;
+        *timeout   -= (s_int32_t)elapsed;
+        *start_tick = now;
+    }
+    return S_OK;
+}
+#endif
+
+#if START_USING_MAILBOX
+/**
+ * @brief Store one value (IRQ lock held, mailbox not full).
+ * @return 1 if a receiver was woken.
+ */
+s_inline s_uint8_t __s_mb_put(s_pmailbox mb, s_uint32_t value)
+{
+    mb->msg_pool[mb->in_offset] = value;
+    if (++mb->in_offset >= mb->size)
+        mb->in_offset = 0;
+    mb->entry++;
+    return __s_ipc_wake_one(&mb->parent.suspend_thread);
+}
+
+/**
+ * @brief Fetch the oldest value (IRQ lock held, mailbox not empty).
+ * @return 1 if a sender was woken.
+ */
+s_inline s_uint8_t __s_mb_get(s_pmailbox mb, s_uint32_t *value)
+{
+    *value = mb->msg_pool[mb->out_offset];
+    if (++mb->out_offset >= mb->size)
+        mb->out_offset = 0;
+    mb->entry--;
+    return __s_ipc_wake_one(&mb->suspend_sender_thread);
+}
+
+/**
+ * @brief Initialize mailbox over an array of size slots.
+ */
+s_status s_mailbox_init(s_pmailbox mb, s_uint32_t *msg_pool, s_uint16_t size, s_uint8_t flag)
+{
+    if (mb == NULL || msg_pool == NULL)
+        return S_NULL;
+    if (size == 0)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&mb->parent.suspend_thread, &mb->suspend_sender_thread, flag) != S_OK)
+        return S_ERR;
+
+    mb->msg_pool      = msg_pool;
+    mb->size          = size;
+    mb->entry         = 0;
+    mb->in_offset     = 0;
+    mb->out_offset    = 0;
+    mb->parent.flag   = flag;
+    mb->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete mailbox (resume all senders and receivers).
+ */
+s_status s_mailbox_delete(s_pmailbox mb)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (mb == NULL)
+        return S_NULL;
+
+    mb->parent.status = 0;
+    if (!s_waitq_isempty(&mb->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&mb->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&mb->suspend_sender_thread))
+    {
+        s_ipc_list_resume_all(&mb->suspend_sender_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&mb->parent.suspend_thread);
+    s_waitq_deinit(&mb->suspend_sender_thread);
+
+    mb->msg_pool    = NULL;
+    mb->size        = 0;
+    mb->entry       = 0;
+    mb->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Send one value, blocking while the mailbox is full.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (full), S_DELETED.
+ */
+s_status s_mailbox_send_wait(s_pmailbox mb, s_uint32_t value, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_status   ret;
+
+    if (mb == NULL)
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (mb->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+
+        if (mb->entry < mb->size)
+        {
+            s_uint8_t woken = __s_mb_put(mb, value);
+            s_irq_enable(level);
+            if (woken)
+                s_sched_switch();
+            return S_OK;
+        }
+
+        ret = __s_ipc_wait(&mb->parent, &mb->suspend_sender_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+}
+
+/**
+ * @brief Non-blocking send (S_TIMEOUT when full).
+ */
+s_status s_mailbox_send(s_pmailbox mb, s_uint32_t value)
+{
+    return s_mailbox_send_wait(mb, value, 0);
+}
+
+/**
+ * @brief Receive the oldest value, blocking while the mailbox is empty.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (empty), S_DELETED.
+ */
+s_status s_mailbox_recv(s_pmailbox mb, s_uint32_t *value, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_status   ret;
+
+    if (mb == NULL || value == NULL)
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (mb->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+
+        if (mb->entry > 0)
+        {
+            s_uint8_t woken = __s_mb_get(mb, value);
+            s_irq_enable(level);
+            if (woken)
+                s_sched_switch();
+            return S_OK;
+        }
+
+        ret = __s_ipc_wait(&mb->parent, &mb->parent.suspend_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+}
+
+/**
+ * @brief ISR send: store one value or fail at once (S_TIMEOUT when full).
+ * @note The switch to a woken receiver is deferred while inside
+ *       s_interrupt_enter()/s_interrupt_leave().
+ */
+s_status s_mailbox_send_from_isr(s_pmailbox mb, s_uint32_t value)
+{
+    register s_uint32_t level;
+    s_uint8_t woken;
+
+    if (mb == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    if (mb->parent.status == 0 || mb->entry >= mb->size)
+    {
+        s_irq_enable(level);
+        return mb->parent.status ? S_TIMEOUT : S_DELETED;
+    }
+    woken = __s_mb_put(mb, value);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief ISR receive: fetch the oldest value or fail at once (S_TIMEOUT when empty).
+ */
+s_status s_mailbox_recv_from_isr(s_pmailbox mb, s_uint32_t *value)
+{
+    register s_uint32_t level;
+    s_uint8_t woken;
+
+    if (mb == NULL || value == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    if (mb->parent.status == 0 || mb->entry == 0)
+    {
+        s_irq_enable(level);
+        return mb->parent.status ? S_TIMEOUT : S_DELETED;
+    }
+    woken = __s_mb_get(mb, value);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+#endif /* START_USING_MAILBOX */
+
+#if START_USING_STREAM
+/**
+ * @brief Copy len bytes into the buffer at offset off (wraps at the end).
+ */
+static void __s_stream_copy_in(s_pstream st, s_uint32_t off,
+                               const s_uint8_t *data, s_uint32_t len)
+{
+    s_uint32_t first = st->size - off;
+
+    if (first > len)
+        first = len;
+
+    /* At most two chunks: up to the end of the buffer, then from its start. */
+    s_memcpy(st->buffer + off, data, first);
+    s_memcpy(st->buffer, data + first, len - first);
+}
+
+/**
+ * @brief Copy len bytes out of the buffer from offset off (wraps at the end).
+ */
+static void __s_stream_copy_out(s_pstream st, s_uint32_t off,
+                                s_uint8_t *data, s_uint32_t len)
+{
+    s_uint32_t first = st->size - off;
+
+    if (first > len)
+        first = len;
+
+    s_memcpy(data, st->buffer + off, first);
+    s_memcpy(data + first, st->buffer, len - first);
+}
+
+/**
+ * @brief Claim len bytes at *offset and advance it (IRQ lock held).
+ * @return Offset of the claimed bytes.
+ */
+s_inline s_uint32_t __s_stream_claim(s_pstream st, s_uint32_t *offset, s_uint32_t len)
+{
+    s_uint32_t off = *offset;
+
+    *offset = off + len >= st->size ? off + len - st->size : off + len;
+    return off;
+}
+
+/**
+ * @brief Wake the first reader once its level is readable and the first
+ *        writer while there is room (IRQ lock held).
+ * @return 1 if a thread was woken.
+ */
+static s_uint8_t __s_stream_notify(s_pstream st)
+{
+    s_uint8_t woken = 0;
+
+    if (st->avail >= st->read_level && __s_ipc_wake_one(&st->parent.suspend_thread))
+    {
+        /* The next reader republishes its own level if it has to wait again. */
+        st->read_level = st->trigger;
+        woken = 1;
+    }
+    if (st->used < st->size)
+        woken |= __s_ipc_wake_one(&st->suspend_writer_thread);
+    return woken;
+}
+
+/**
+ * @brief Initialize a byte stream over size bytes of buffer.
+ * @param trigger Stored bytes that wake a blocked reader (1..size).
+ */
+s_status s_stream_init(s_pstream st, void *buffer, s_uint32_t size,
+                       s_uint32_t trigger, s_uint8_t flag)
+{
+    if (st == NULL || buffer == NULL)
+        return S_NULL;
+    if (size == 0 || trigger == 0 || trigger > size)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&st->parent.suspend_thread, &st->suspend_writer_thread, flag) != S_OK)
+        return S_ERR;
+
+    st->buffer        = (s_uint8_t *)buffer;
+    st->size          = size;
+    st->used          = 0;
+    st->avail         = 0;
+    st->filled        = 0;
+    st->drained       = 0;
+    st->in_offset     = 0;
+    st->out_offset    = 0;
+    st->writers       = 0;
+    st->readers       = 0;
+    st->trigger       = trigger;
+    st->read_level    = trigger;
+    st->parent.flag   = flag;
+    st->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete stream (resume all writers and readers).
+ */
+s_status s_stream_delete(s_pstream st)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (st == NULL)
+        return S_NULL;
+
+    st->parent.status = 0;
+    if (!s_waitq_isempty(&st->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&st->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&st->suspend_writer_thread))
+    {
+        s_ipc_list_resume_all(&st->suspend_writer_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&st->parent.suspend_thread);
+    s_waitq_deinit(&st->suspend_writer_thread);
+
+    /* buffer and size stay valid for copies still in flight; those skip
+     * their accounting once they see the stream deleted. */
+    st->used        = 0;
+    st->avail       = 0;
+    st->filled      = 0;
+    st->drained     = 0;
+    st->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Bytes currently readable.
+ */
+s_uint32_t s_stream_count(s_pstream st)
+{
+    return st->avail;
+}
+
+/**
+ * @brief Write len bytes, blocking while the buffer is full.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return Bytes written: len, or fewer on timeout / deletion. Writes of
+ *         several writers may interleave once a write has to wait.
+ * @note Room is claimed under the IRQ lock and filled with it released.
+ *       Claimed bytes turn readable once every writer copying into the
+ *       buffer has finished.
+ */
+s_uint32_t s_stream_write(s_pstream st, const void *data, s_uint32_t len, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    const s_uint8_t *src = (const s_uint8_t *)data;
+    s_uint32_t start_tick = 0;
+    s_uint32_t done = 0;
+    s_uint32_t off, n;
+    s_uint8_t  woken;
+
+    if (st == NULL || data == NULL)
+        return 0;
+
+    while (done < len)
+    {
+        level = s_irq_disable();
+        if (st->parent.status == 0)
+        {
+            s_irq_enable(level);
+            break;
+        }
+
+        if (st->used == st->size)
+        {
+            if (timeout == 0)
+            {
+                s_irq_enable(level);
+                break;
+            }
+            if (__s_ipc_wait(&st->parent, &st->suspend_writer_thread, level,
+                             &timeout, &start_tick) != S_OK)
+                break;
+            continue;
+        }
+
+        n = st->size - st->used;
+        if (n > len - done)
+            n = len - done;
+        off = __s_stream_claim(st, &st->in_offset, n);
+        st->used += n;
+        st->writers++;
+        s_irq_enable(level);
+
+        __s_stream_copy_in(st, off, src + done, n);
+        done += n;
+
+        level = s_irq_disable();
+        if (st->parent.status == 0)
+        {
+            s_irq_enable(level);
+            break;
+        }
+        st->filled += n;
+        /* Earlier claims may still be copying: publish when the last one ends. */
+        if (--st->writers == 0)
+        {
+            st->avail += st->filled;
+            st->filled = 0;
+        }
+        woken = __s_stream_notify(st);
+        s_irq_enable(level);
+
+        if (woken)
+            s_sched_switch();
+    }
+    return done;
+}
+
+/**
+ * @brief Read up to len bytes.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return Bytes read. A blocking read waits until min(len, trigger) bytes
+ *         are readable, then takes everything available up to len in one
+ *         copy; on timeout it returns what is readable (possibly 0).
+ * @note The bytes are claimed under the IRQ lock and copied with it
+ *       released; their room is handed back to writers once every reader
+ *       copying out of the buffer has finished.
+ */
+s_uint32_t s_stream_read(s_pstream st, void *data, s_uint32_t len, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint32_t need, off;
+    s_uint8_t  woken;
+    s_status   ret;
+
+    if (st == NULL || data == NULL || len == 0)
+        return 0;
+
+    need = len < st->trigger ? len : st->trigger;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (st->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return 0;
+        }
+
+        if (st->avail >= need || timeout == 0)
+            break;
+
+        st->read_level = need;
+        ret = __s_ipc_wait(&st->parent, &st->parent.suspend_thread, level,
+                           &timeout, &start_tick);
+        if (ret == S_TIMEOUT)
+        {
+            timeout = 0;
+            continue;
+        }
+        if (ret != S_OK)
+            return 0;
+    }
+
+    if (len > st->avail)
+        len = st->avail;
+    if (len == 0)
+    {
+        s_irq_enable(level);
+        return 0;
+    }
+    off = __s_stream_claim(st, &st->out_offset, len);
+    st->avail -= len;
+    st->readers++;
+    s_irq_enable(level);
+
+    __s_stream_copy_out(st, off, (s_uint8_t *)data, len);
+
+    level = s_irq_disable();
+    if (st->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return len;
+    }
+    st->drained += len;
+    /* Room is contiguous only once every earlier claim is copied out. */
+    if (--st->readers == 0)
+    {
+        st->used -= st->drained;
+        st->drained = 0;
+    }
+    woken = __s_stream_notify(st);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return len;
+}
+
+/**
+ * @brief ISR write: store what fits at once, never blocks.
+ * @return Bytes written.
+ */
+s_uint32_t s_stream_write_from_isr(s_pstream st, const void *data, s_uint32_t len)
+{
+    return s_stream_write(st, data, len, 0);
+}
+
+/**
+ * @brief ISR read: take what is stored at once, never blocks.
+ * @return Bytes read.
+ */
+s_uint32_t s_stream_read_from_isr(s_pstream st, void *data, s_uint32_t len)
+{
+    return s_stream_read(st, data, len, 0);
+}
+#endif /* START_USING_STREAM */
+
+#if START_USING_VMSGQUEUE
+/**
+ * @brief Offset len bytes past off (wraps at the end).
+ */
+s_inline s_uint32_t __s_vmq_advance(s_pvmsgqueue vq, s_uint32_t off, s_uint32_t len)
+{
+    off += len;
+    return off >= vq->pool_size ? off - vq->pool_size : off;
+}
+
+/**
+ * @brief Copy len bytes into the pool at offset off (wraps at the end).
+ */
+static void __s_vmq_copy_in(s_pvmsgqueue vq, s_uint32_t off,
+                            const void *data, s_uint32_t len)
+{
+    const s_uint8_t *src = (const s_uint8_t *)data;
+    s_uint32_t first = vq->pool_size - off;
+
+    if (first >= len)
+        s_memcpy(vq->pool + off, src, len);
+    else
+    {
+        s_memcpy(vq->pool + off, src, first);
+        s_memcpy(vq->pool, src + first, len - first);
+    }
+}
+
+/**
+ * @brief Copy len bytes out of the pool from offset off (wraps at the end).
+ */
+static void __s_vmq_copy_out(s_pvmsgqueue vq, s_uint32_t off,
+                             void *data, s_uint32_t len)
+{
+    s_uint8_t *dst = (s_uint8_t *)data;
+    s_uint32_t first = vq->pool_size - off;
+
+    if (first >= len)
+        s_memcpy(dst, vq->pool + off, len);
+    else
+    {
+        s_memcpy(dst, vq->pool + off, first);
+        s_memcpy(dst + first, vq->pool, len - first);
+    }
+}
+
+/**
+ * @brief Store the length prefix at in_offset (byte-wise, may wrap).
+ */
+s_inline void __s_vmq_put_len(s_pvmsgqueue vq, s_uint16_t len)
+{
+    s_uint32_t off = vq->in_offset;
+
+    vq->pool[off] = (s_uint8_t)len;
+    if (++off == vq->pool_size)
+        off = 0;
+    vq->pool[off] = (s_uint8_t)(len >> 8);
+    if (++off == vq->pool_size)
+        off = 0;
+    vq->in_offset = off;
+}
+
+/**
+ * @brief Read the length prefix at out_offset without consuming it.
+ * @return Offset of the payload.
+ */
+s_inline s_uint32_t __s_vmq_peek_len(s_pvmsgqueue vq, s_uint16_t *len)
+{
+    s_uint32_t off = vq->out_offset;
+    s_uint16_t lo  = vq->pool[off];
+
+    if (++off == vq->pool_size)
+        off = 0;
+    *len = (s_uint16_t)(lo | (vq->pool[off] << 8));
+    if (++off == vq->pool_size)
+        off = 0;
+    return off;
+}
+
+/**
+ * @brief Initialize a variable-length message queue over pool_size bytes.
+ * @note Each message takes START_VMSGQ_HDR_SIZE + its length bytes; size the
+ *       pool with START_VMSGQ_POOL_SIZE(total payload bytes, messages).
+ */
+s_status s_vmsgqueue_init(s_pvmsgqueue vq, void *pool, s_uint32_t pool_size, s_uint8_t flag)
+{
+    if (vq == NULL || pool == NULL)
+        return S_NULL;
+    if (pool_size <= START_VMSGQ_HDR_SIZE)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&vq->parent.suspend_thread, &vq->suspend_sender_thread, flag) != S_OK)
+        return S_ERR;
+
+    vq->pool          = (s_uint8_t *)pool;
+    vq->pool_size     = pool_size;
+    vq->used          = 0;
+    vq->drained       = 0;
+    vq->in_offset     = 0;
+    vq->out_offset    = 0;
+    vq->entry         = 0;
+    vq->filled        = 0;
+    vq->senders       = 0;
+    vq->receivers     = 0;
+    vq->parent.flag   = flag;
+    vq->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete queue (resume all senders and receivers).
+ */
+s_status s_vmsgqueue_delete(s_pvmsgqueue vq)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (vq == NULL)
+        return S_NULL;
+
+    vq->parent.status = 0;
+    if (!s_waitq_isempty(&vq->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&vq->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&vq->suspend_sender_thread))
+    {
+        s_ipc_list_resume_all(&vq->suspend_sender_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&vq->parent.suspend_thread);
+    s_waitq_deinit(&vq->suspend_sender_thread);
+
+    /* pool and pool_size stay valid for copies still in flight; those skip
+     * their accounting once they see the queue deleted. */
+    vq->used        = 0;
+    vq->drained     = 0;
+    vq->entry       = 0;
+    vq->filled      = 0;
+    vq->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Append one size-byte message, blocking until it fits.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (no room), S_DELETED, S_INVALID (larger than the pool).
+ * @note The record is claimed under the IRQ lock and its payload copied
+ *       with the lock released. It turns receivable once every sender
+ *       copying into the pool has finished.
+ */
+s_status s_vmsgqueue_send_wait(s_pvmsgqueue vq, const void *buffer, s_uint16_t size,
+                               s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint32_t need = START_VMSGQ_HDR_SIZE + (s_uint32_t)size;
+    s_uint32_t off;
+    s_uint8_t  woken = 0;
+    s_status   ret;
+
+    if (vq == NULL || (buffer == NULL && size))
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (vq->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+        if (need > vq->pool_size)
+        {
+            s_irq_enable(level);
+            return S_INVALID;
+        }
+        if (vq->pool_size - vq->used >= need)
+            break;
+
+        ret = __s_ipc_wait(&vq->parent, &vq->suspend_sender_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+    __s_vmq_put_len(vq, size);
+    off = vq->in_offset;
+    vq->in_offset = __s_vmq_advance(vq, off, size);
+    vq->used += need;
+    vq->senders++;
+    s_irq_enable(level);
+
+    __s_vmq_copy_in(vq, off, buffer, size);
+
+    level = s_irq_disable();
+    if (vq->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+    vq->filled++;
+    /* Earlier claims may still be copying: publish when the last one ends. */
+    if (--vq->senders == 0)
+    {
+        vq->entry += vq->filled;
+        vq->filled = 0;
+        woken = __s_ipc_wake_one(&vq->parent.suspend_thread);
+    }
+    /* Pass the remaining room on to the next blocked sender. */
+    if (vq->pool_size - vq->used > START_VMSGQ_HDR_SIZE)
+        woken |= __s_ipc_wake_one(&vq->suspend_sender_thread);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Non-blocking send (S_TIMEOUT when the message does not fit).
+ */
+s_status s_vmsgqueue_send(s_pvmsgqueue vq, const void *buffer, s_uint16_t size)
+{
+    return s_vmsgqueue_send_wait(vq, buffer, size, 0);
+}
+
+/**
+ * @brief Take the oldest message, blocking while the queue is empty.
+ * @param size Capacity of buffer.
+ * @param len Receives the message length (may be NULL).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (empty), S_DELETED, S_INVALID when the message is
+ *         longer than size (it stays queued, *len tells the length needed).
+ * @note The record is claimed under the IRQ lock and copied with the lock
+ *       released. Its room is handed back once every receiver copying out
+ *       of the pool has finished.
+ */
+s_status s_vmsgqueue_recv(s_pvmsgqueue vq, void *buffer, s_uint16_t size,
+                          s_uint16_t *len, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint32_t off;
+    s_uint16_t hdr;
+    s_uint8_t  woken = 0;
+    s_status   ret;
+
+    if (vq == NULL || (buffer == NULL && size))
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (vq->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+        if (vq->entry > 0)
+            break;
+
+        ret = __s_ipc_wait(&vq->parent, &vq->parent.suspend_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+    off = __s_vmq_peek_len(vq, &hdr);
+    if (len)
+        *len = hdr;
+    if (hdr > size)
+    {
+        s_irq_enable(level);
+        return S_INVALID;
+    }
+    vq->out_offset = __s_vmq_advance(vq, off, hdr);
+    vq->entry--;
+    vq->receivers++;
+    s_irq_enable(level);
+
+    __s_vmq_copy_out(vq, off, buffer, hdr);
+
+    level = s_irq_disable();
+    if (vq->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+    vq->drained += START_VMSGQ_HDR_SIZE + (s_uint32_t)hdr;
+    /* Room is contiguous only once every earlier claim is copied out. */
+    if (--vq->receivers == 0)
+    {
+        vq->used -= vq->drained;
+        vq->drained = 0;
+        woken = __s_ipc_wake_one(&vq->suspend_sender_thread);
+    }
+    if (vq->entry > 0)
+        woken |= __s_ipc_wake_one(&vq->parent.suspend_thread);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+#endif /* START_USING_VMSGQUEUE */
+
+#if START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE
+#if START_PRIOQ_LEVELS < 1 || START_PRIOQ_LEVELS > 32
+#error "START_PRIOQ_LEVELS must be 1..32"
+#endif
+
+/**
+ * @brief Initialize a priority message queue over a START_MSGQ_POOL_SIZE pool.
+ */
+s_status s_prioqueue_init(s_pprioqueue pq, void *msg_pool, s_uint16_t msg_size,
+                          s_uint16_t pool_size, s_uint8_t flag)
+{
+    struct s_mq_message *node;
+    s_uint16_t aligned_size;
+    s_uint16_t node_size;
+
+    if (pq == NULL || msg_pool == NULL)
+        return S_NULL;
+    if (msg_size == 0)
+        return S_INVALID;
+
+    aligned_size = (s_uint16_t)START_ALIGN_UP(msg_size, sizeof(s_uint32_t));
+    node_size    = (s_uint16_t)(aligned_size + sizeof(struct s_mq_message));
+    if (pool_size < node_size)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&pq->parent.suspend_thread, &pq->suspend_sender_thread, flag) != S_OK)
+        return S_ERR;
+
+    pq->msg_pool       = msg_pool;
+    pq->msg_size       = aligned_size;
+    pq->max_msgs       = (s_uint16_t)(pool_size / node_size);
+    pq->index          = 0;
+    pq->ready          = 0;
+    pq->msg_queue_free = NULL;
+    for (int i = 0; i < START_PRIOQ_LEVELS; i++)
+    {
+        pq->head[i] = NULL;
+        pq->tail[i] = NULL;
+    }
+
+    for (s_uint16_t i = 0; i < pq->max_msgs; i++)
+    {
+        node = (struct s_mq_message *)((s_uint8_t *)msg_pool + i * node_size);
+        node->next         = pq->msg_queue_free;
+        pq->msg_queue_free = node;
+    }
+
+    pq->parent.flag   = flag;
+    pq->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete queue (resume all senders and receivers).
+ */
+s_status s_prioqueue_delete(s_pprioqueue pq)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (pq == NULL)
+        return S_NULL;
+
+    pq->parent.status = 0;
+    if (!s_waitq_isempty(&pq->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&pq->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&pq->suspend_sender_thread))
+    {
+        s_ipc_list_resume_all(&pq->suspend_sender_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&pq->parent.suspend_thread);
+    s_waitq_deinit(&pq->suspend_sender_thread);
+
+    pq->msg_pool       = NULL;
+    pq->msg_queue_free = NULL;
+    pq->index          = 0;
+    pq->ready          = 0;
+    pq->parent.flag    = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Send one message at priority prio (0 = highest), blocking while full.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (full), S_DELETED, S_INVALID (size / prio).
+ * @note The payload is copied with the IRQ lock released; queueing is O(1):
+ *       append to the sublist of prio and set its ready bit.
+ */
+s_status s_prioqueue_send_wait(s_pprioqueue pq, const void *buffer, s_uint16_t size,
+                               s_uint8_t prio, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    struct s_mq_message *node;
+    s_uint32_t start_tick = 0;
+    s_uint8_t  woken;
+    s_status   ret;
+
+    if (pq == NULL || buffer == NULL)
+        return S_NULL;
+    if (size == 0 || size > pq->msg_size || prio >= START_PRIOQ_LEVELS)
+        return S_INVALID;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (pq->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+        if (pq->msg_queue_free != NULL)
+            break;
+
+        ret = __s_ipc_wait(&pq->parent, &pq->suspend_sender_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+    node               = pq->msg_queue_free;
+    pq->msg_queue_free = node->next;
+    s_irq_enable(level);
+
+    s_memcpy(node + 1, buffer, size);
+
+    S_TRACE(S_TRACE_EV_MQ_SEND, pq, prio);
+
+    level = s_irq_disable();
+    node->next = NULL;
+    if (pq->tail[prio])
+        pq->tail[prio]->next = node;
+    else
+        pq->head[prio] = node;
+    pq->tail[prio] = node;
+    pq->ready |= 1UL << prio;
+    pq->index++;
+    woken = __s_ipc_wake_one(&pq->parent.suspend_thread);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Non-blocking send (S_TIMEOUT when full).
+ */
+s_status s_prioqueue_send(s_pprioqueue pq, const void *buffer, s_uint16_t size, s_uint8_t prio)
+{
+    return s_prioqueue_send_wait(pq, buffer, size, prio, 0);
+}
+
+/**
+ * @brief Receive the oldest message of the highest pending priority.
+ * @param prio Receives the message priority (may be NULL).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (empty), S_DELETED.
+ */
+s_status s_prioqueue_recv(s_pprioqueue pq, void *buffer, s_uint16_t size,
+                          s_uint8_t *prio, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    struct s_mq_message *node;
+    s_uint32_t start_tick = 0;
+    s_uint8_t  top;
+    s_uint8_t  woken;
+    s_status   ret;
+
+    if (pq == NULL || buffer == NULL)
+        return S_NULL;
+    if (size == 0)
+        return S_INVALID;
+
+    S_TRACE(S_TRACE_EV_MQ_RECV, pq, 0);
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (pq->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+        if (pq->ready)
+            break;
+
+        ret = __s_ipc_wait(&pq->parent, &pq->parent.suspend_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+
+    /* Lowest set bit = highest priority, as in the scheduler ready map. */
+    top  = (s_uint8_t)(__s_ffs((int)pq->ready) - 1);
+    node = pq->head[top];
+    pq->head[top] = node->next;
+    if (pq->head[top] == NULL)
+    {
+        pq->tail[top] = NULL;
+        pq->ready &= ~(1UL << top);
+    }
+    pq->index--;
+    s_irq_enable(level);
+
+    s_memcpy(buffer, node + 1, size > pq->msg_size ? pq->msg_size : size);
+    if (prio)
+        *prio = top;
+
+    level = s_irq_disable();
+    node->next         = pq->msg_queue_free;
+    pq->msg_queue_free = node;
+    woken = __s_ipc_wake_one(&pq->suspend_sender_thread);
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+#endif /* START_USING_MESSAGEQUEUE && START_USING_PRIOQUEUE */
+
+#if START_USING_EVENT
+/**
+ * @brief Flags of set that satisfy a waiter (0 = keep waiting).
+ * @param pending Flags currently pending in the group.
+ * @param set Flags the waiter asked for.
+ * @param option START_EVENT_FLAG_AND or START_EVENT_FLAG_OR (+ CLEAR).
+ */
+s_inline s_uint32_t __s_event_match(s_uint32_t pending, s_uint32_t set, s_uint8_t option)
+{
+    if (option & START_EVENT_FLAG_AND)
+        return ((pending & set) == set) ? set : 0;
+    return pending & set;
+}
+
+/**
+ * @brief Initialize an event flag group with no flag pending.
+ */
+s_status s_event_init(s_pevent event, s_uint8_t flag)
+{
+    if (event == NULL)
+        return S_NULL;
+
+    if (s_waitq_init(&event->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
+    event->set           = 0;
+    event->parent.flag   = flag;
+    event->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete event flag group (waiters return S_DELETED).
+ */
+s_status s_event_delete(s_pevent event)
+{
+    s_uint8_t need_schedule = 0;
+    if (event == NULL)
+        return S_NULL;
+
+    event->parent.status = 0;
+    if (!s_waitq_isempty(&event->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&event->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&event->parent.suspend_thread);
+
+    event->set         = 0;
+    event->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Wake the waiters of one wait list that event->set satisfies (IRQ lock held).
+ * @param clear Collects flags to consume once every list was scanned.
+ * @return 1 if a thread was made ready.
+ */
+static s_uint8_t __s_event_scan(s_pevent event, s_plist head, s_uint32_t *clear)
+{
+    s_plist    p = head->next;
+    s_pthread  thread;
+    s_uint32_t matched;
+    s_uint8_t  woken = 0;
+
+    while (p != head)
+    {
+        thread = S_LIST_ENTRY(p, s_thread, tlist);
+        p = p->next;
+
+        matched = __s_event_match(event->set, thread->event_set, thread->event_info);
+        if (matched == 0)
+            continue;
+
+        if (thread->event_info & START_EVENT_FLAG_CLEAR)
+            *clear |= matched;
+        thread->event_set  = matched;
+        thread->event_info = 0;
+
+        s_timer_stop(&(thread->timer));
+        s_list_delete(&thread->tlist);
+        thread->status = START_THREAD_READY;
+        s_sched_insert_thread(thread);
+        woken = 1;
+    }
+    return woken;
+}
+
+/**
+ * @brief Set flags and wake every waiter they satisfy.
+ * @note Never blocks (usable from ISRs). All satisfied waiters are made ready
+ *       in one critical section, then a single s_sched_switch() runs. Flags
+ *       consumed with START_EVENT_FLAG_CLEAR are removed after the pass, so
+ *       every waiter woken by this call sees them.
+ */
+s_status s_event_send(s_pevent event, s_uint32_t set)
+{
+    register s_uint32_t level;
+    s_waitq   *q;
+    s_uint32_t clear = 0;
+    s_uint8_t  need_schedule = 0;
+
+    if (event == NULL)
+        return S_NULL;
+    if (event->parent.status == 0)
+        return S_DELETED;
+    if (set == 0)
+        return S_INVALID;
+
+    q = &event->parent.suspend_thread;
+    level = s_irq_disable();
+    event->set |= set;
+
+    /* Every waiter is checked, most urgent priority first. */
+#if START_IPC_WAIT_POOL > 0
+    if (q->prio != NULL)
+    {
+        for (s_uint32_t n = __s_waitq_next(q->prio, 0); n < START_THREAD_PRIORITY_MAX;
+             n = __s_waitq_next(q->prio, n + 1))
+            need_schedule |= __s_event_scan(event, &q->prio->level[n], &clear);
+    }
+#endif
+    need_schedule |= __s_event_scan(event, &q->list, &clear);
+    event->set &= ~clear;
+    s_irq_enable(level);
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Wait for flags of set (all with AND, any with OR).
+ * @param option START_EVENT_FLAG_AND or START_EVENT_FLAG_OR, optionally
+ *        | START_EVENT_FLAG_CLEAR to consume the received flags.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @param recved Receives the matched flags (may be NULL).
+ * @return S_OK, S_TIMEOUT (also for no wait) or S_DELETED.
+ */
+s_status s_event_recv(s_pevent event, s_uint32_t set, s_uint8_t option,
+                      s_int32_t timeout, s_uint32_t *recved)
+{
+    register s_uint32_t level;
+    s_pthread  thread;
+    s_uint32_t matched;
+
+    if (event == NULL)
+        return S_NULL;
+    if (event->parent.status == 0)
+        return S_DELETED;
+    if (set == 0 || !(option & (START_EVENT_FLAG_AND | START_EVENT_FLAG_OR)))
+        return S_INVALID;
+
+    level = s_irq_disable();
+    matched = __s_event_match(event->set, set, option);
+    if (matched)
+    {
+        if (option & START_EVENT_FLAG_CLEAR)
+            event->set &= ~matched;
+        s_irq_enable(level);
+        if (recved)
+            *recved = matched;
+        return S_OK;
+    }
+    if (timeout == 0)
+    {
+        s_irq_enable(level);
+        return S_TIMEOUT;
+    }
+
+    thread = s_thread_get_blockable();
+    if (thread == NULL)
+    {
+        s_irq_enable(level);
+        return S_UNSUPPORTED;
+    }
+
+    /* s_event_send() matches against these and zeroes event_info on wakeup. */
+    thread->event_set  = set;
+    thread->event_info = option;
+    s_ipc_suspend(&event->parent.suspend_thread, thread, event->parent.flag);
+
+    if (timeout > 0)
+    {
+        s_timer_ctrl(&(thread->timer), START_TIMER_SET_TIME, &timeout);
+        s_timer_start(&(thread->timer));
+    }
+
+    s_irq_enable(level);
+    s_sched_switch();
+    s_timer_stop(&(thread->timer));
+
+    level = s_irq_disable();
+    if (thread->event_info == 0)
+    {
+        matched = thread->event_set;
+        s_irq_enable(level);
+        if (recved)
+            *recved = matched;
+        return S_OK;
+    }
+    thread->event_info = 0;
+    s_irq_enable(level);
+    return event->parent.status ? S_TIMEOUT : S_DELETED;
+}
+#endif /* START_USING_EVENT */
+
+#if START_USING_RWLOCK
+/**
+ * @brief Wake whoever may proceed now that the lock is free or shared (IRQ lock held).
+ * @return 1 if a thread was woken.
+ * @note Woken threads retake the lock themselves. A woken writer stays in
+ *       writers until it runs, so with writer preference no reader slips in.
+ */
+static s_uint8_t __s_rwlock_wake(s_prwlock rw)
+{
+    s_uint8_t woken = 0;
+
+    if (rw->owner != NULL)
+        return 0;
+
+    if (rw->readers == 0 && !s_waitq_isempty(&rw->suspend_writer_thread) &&
+        (rw->prefer == START_RWLOCK_PREFER_WRITER || s_waitq_isempty(&rw->parent.suspend_thread)))
+        return __s_ipc_wake_one(&rw->suspend_writer_thread);
+
+    if (rw->prefer == START_RWLOCK_PREFER_WRITER && rw->writers)
+        return 0;
+
+    while (__s_ipc_wake_one(&rw->parent.suspend_thread))
+        woken = 1;
+    return woken;
+}
+
+/**
+ * @brief Initialize reader-writer lock.
+ * @param flag Wait queue policy (START_IPC_FLAG_FIFO / PRIO) of both queues.
+ * @param prefer START_RWLOCK_PREFER_READER or START_RWLOCK_PREFER_WRITER.
+ */
+s_status s_rwlock_init(s_prwlock rw, s_uint8_t flag, s_uint8_t prefer)
+{
+    if (rw == NULL)
+        return S_NULL;
+    if (prefer != START_RWLOCK_PREFER_READER && prefer != START_RWLOCK_PREFER_WRITER)
+        return S_INVALID;
+
+    if (__s_waitq_init_pair(&rw->parent.suspend_thread, &rw->suspend_writer_thread, flag) != S_OK)
+        return S_ERR;
+    rw->owner             = NULL;
+    rw->readers           = 0;
+    rw->writers           = 0;
+    rw->original_priority = 0xFF;
+    rw->prefer            = prefer;
+    rw->parent.flag       = flag;
+    rw->parent.status     = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete lock: resume all readers and writers (S_DELETED), restore writer priority.
+ */
+s_status s_rwlock_delete(s_prwlock rw)
+{
+    register s_uint32_t level;
+    s_uint8_t need_schedule = 0;
+
+    if (rw == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    rw->parent.status = 0;
+    if (rw->owner != NULL)
+        __s_ipc_restore(rw->owner, rw->original_priority);
+    rw->owner             = NULL;
+    rw->readers           = 0;
+    rw->original_priority = 0xFF;
+    s_irq_enable(level);
+
+    if (!s_waitq_isempty(&rw->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&rw->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    if (!s_waitq_isempty(&rw->suspend_writer_thread))
+    {
+        s_ipc_list_resume_all(&rw->suspend_writer_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&rw->parent.suspend_thread);
+    s_waitq_deinit(&rw->suspend_writer_thread);
+    rw->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Take the lock shared.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT, S_DELETED, S_UNSUPPORTED (blocking outside a thread
+ *         or with the scheduler locked).
+ * @note Blocks while a writer holds the lock and, with writer preference,
+ *       while a writer waits; a blocked reader lends its priority to the
+ *       writer holding the lock. Readers are not tracked individually, so a
+ *       waiting writer boosts nobody, and a thread that already reads must
+ *       not take the lock again under writer preference.
+ */
+s_status s_rwlock_take_read(s_prwlock rw, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_pthread  self;
+    s_status   ret;
+
+    if (rw == NULL)
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (rw->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+
+        if (rw->owner == NULL &&
+            (rw->prefer == START_RWLOCK_PREFER_READER || rw->writers == 0))
+        {
+            rw->readers++;
+            s_irq_enable(level);
+            return S_OK;
+        }
+
+        self = s_thread_get_blockable();
+        if (timeout != 0 && self != NULL)
+            __s_ipc_inherit(rw->owner, self, &rw->original_priority);
+
+        ret = __s_ipc_wait(&rw->parent, &rw->parent.suspend_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+}
+
+/**
+ * @brief Take the lock exclusively (not recursive).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT, S_DELETED, S_INVALID (caller already writes),
+ *         S_UNSUPPORTED (outside a thread, or blocking with the scheduler locked).
+ * @note Same priority inheritance as s_mutex_take() towards a writer owner.
+ */
+s_status s_rwlock_take_write(s_prwlock rw, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint8_t  counted = 0;
+    s_uint8_t  woken;
+    s_pthread  self;
+    s_status   ret;
+
+    if (rw == NULL)
+        return S_NULL;
+
+    self = s_thread_get();
+    if (self == NULL)
+        return S_UNSUPPORTED;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (rw->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+        if (rw->owner == self)
+        {
+            s_irq_enable(level);
+            return S_INVALID;
+        }
+
+        if (rw->owner == NULL && rw->readers == 0)
+        {
+            rw->owner             = self;
+            rw->original_priority = self->current_priority;
+            if (counted)
+                rw->writers--;
+            s_irq_enable(level);
+            return S_OK;
+        }
+
+        if (timeout != 0 && s_sched_get_lock_nest() == 0)
+        {
+            __s_ipc_inherit(rw->owner, self, &rw->original_priority);
+            if (!counted)
+            {
+                rw->writers++;
+                counted = 1;
+            }
+        }
+
+        ret = __s_ipc_wait(&rw->parent, &rw->suspend_writer_thread, level, &timeout, &start_tick);
+        if (ret == S_OK)
+            continue;
+
+        /* Gave up: readers held back for this writer may go now. */
+        woken = 0;
+        level = s_irq_disable();
+        if (counted && rw->parent.status)
+        {
+            rw->writers--;
+            woken = __s_rwlock_wake(rw);
+        }
+        s_irq_enable(level);
+        if (woken)
+            s_sched_switch();
+        return ret;
+    }
+}
+
+/**
+ * @brief Release a shared or exclusive hold.
+ * @return S_OK, S_ERR if the caller holds neither (or another thread writes).
+ */
+s_status s_rwlock_release(s_prwlock rw)
+{
+    register s_uint32_t level;
+    s_uint8_t need_schedule;
+
+    if (rw == NULL)
+        return S_NULL;
+    if (rw->parent.status == 0)
+        return S_DELETED;
+
+    level = s_irq_disable();
+    if (rw->owner != NULL)
+    {
+        if (rw->owner != s_thread_get())
+        {
+            s_irq_enable(level);
+            return S_ERR;
+        }
+        __s_ipc_restore(rw->owner, rw->original_priority);
+        rw->owner             = NULL;
+        rw->original_priority = 0xFF;
+    }
+    else if (rw->readers > 0)
+    {
+        rw->readers--;
+    }
+    else
+    {
+        s_irq_enable(level);
+        return S_ERR;
+    }
+
+    need_schedule = __s_rwlock_wake(rw);
+    s_irq_enable(level);
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+#endif /* START_USING_RWLOCK */
+
+#if START_USING_BARRIER
+/**
+ * @brief Initialize barrier for parties threads per phase.
+ */
+s_status s_barrier_init(s_pbarrier barrier, s_uint16_t parties, s_uint8_t flag)
+{
+    if (barrier == NULL)
+        return S_NULL;
+    if (parties == 0)
+        return S_INVALID;
+
+    if (s_waitq_init(&barrier->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
+    barrier->parties       = parties;
+    barrier->arrived       = 0;
+    barrier->phase         = 0;
+    barrier->parent.flag   = flag;
+    barrier->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete barrier, resume waiters (S_DELETED).
+ */
+s_status s_barrier_delete(s_pbarrier barrier)
+{
+    s_uint8_t need_schedule = 0;
+
+    if (barrier == NULL)
+        return S_NULL;
+
+    barrier->parent.status = 0;
+    if (!s_waitq_isempty(&barrier->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&barrier->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&barrier->parent.suspend_thread);
+    barrier->arrived     = 0;
+    barrier->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Block until parties threads have arrived, then start the next phase.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT (arrival withdrawn), S_DELETED, S_UNSUPPORTED.
+ * @note The last arriver resumes every waiter with one bulk wake and a
+ *       single reschedule, and does not block itself.
+ */
+s_status s_barrier_wait(s_pbarrier barrier, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t phase;
+    s_pthread  self;
+
+    if (barrier == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    if (barrier->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+
+    if (++barrier->arrived >= barrier->parties)
+    {
+        barrier->arrived = 0;
+        barrier->phase++;
+        s_ipc_list_resume_all(&barrier->parent.suspend_thread);
+        s_irq_enable(level);
+        s_sched_switch();
+        return S_OK;
+    }
+
+    self = s_thread_get_blockable();
+    if (timeout == 0 || self == NULL)
+    {
+        barrier->arrived--;
+        s_irq_enable(level);
+        return timeout == 0 ? S_TIMEOUT : S_UNSUPPORTED;
+    }
+
+    phase = barrier->phase;
+    s_ipc_suspend(&barrier->parent.suspend_thread, self, barrier->parent.flag);
+    if (timeout > 0)
+    {
+        s_timer_ctrl(&self->timer, START_TIMER_SET_TIME, &timeout);
+        s_timer_start(&self->timer);
+    }
+    s_irq_enable(level);
+
+    s_sched_switch();
+    s_timer_stop(&self->timer);
+
+    level = s_irq_disable();
+    if (barrier->parent.status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+    if (barrier->phase == phase)
+    {
+        /* Timed out before the phase completed: take the arrival back. */
+        barrier->arrived--;
+        s_irq_enable(level);
+        return S_TIMEOUT;
+    }
+    s_irq_enable(level);
+    return S_OK;
+}
+#endif /* START_USING_BARRIER */
+
+#if START_USING_WAITSET
+#define S_WAITSET_SEM       0x01
+#define S_WAITSET_MSGQUEUE  0x02
+
+/**
+ * @brief Whether member i can be taken without blocking (IRQ lock held).
+ * @note A deleted object detaches itself, so members are always valid.
+ */
+static s_uint8_t __s_waitset_ready(s_pwaitset ws, s_uint8_t i)
+{
+    switch (ws->type[i])
+    {
+#if START_USING_SEMAPHORE
+    case S_WAITSET_SEM:
+        return ((s_psem)ws->member[i])->count > 0;
+#endif
+#if START_USING_MESSAGEQUEUE
+    case S_WAITSET_MSGQUEUE:
+        return ((s_pmsgqueue)ws->member[i])->index > 0;
+#endif
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Register an object; wakes a waiter at once if it is already ready.
+ */
+static s_status __s_waitset_add(s_pwaitset ws, struct ipc_parent *parent, s_uint8_t type)
+{
+    register s_uint32_t level;
+    s_uint8_t woken = 0;
+
+    if (ws == NULL || parent == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    if (ws->parent.status == 0 || parent->status == 0)
+    {
+        s_irq_enable(level);
+        return S_DELETED;
+    }
+    if (parent->set != NULL)
+    {
+        s_irq_enable(level);
+        return S_BUSY;
+    }
+    if (ws->count >= START_WAITSET_MAX)
+    {
+        s_irq_enable(level);
+        return S_INVALID;
+    }
+
+    ws->member[ws->count] = parent;
+    ws->type[ws->count]   = type;
+    parent->set           = ws;
+    if (__s_waitset_ready(ws, ws->count))
+        woken = __s_waitset_notify(parent);
+    ws->count++;
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Initialize an empty wait set.
+ */
+s_status s_waitset_init(s_pwaitset ws, s_uint8_t flag)
+{
+    if (ws == NULL)
+        return S_NULL;
+
+    if (s_waitq_init(&ws->parent.suspend_thread, flag) != S_OK)
+        return S_ERR;
+    ws->count         = 0;
+    ws->next          = 0;
+    ws->parent.flag   = flag;
+    ws->parent.status = 1;
+    return S_OK;
+}
+
+/**
+ * @brief Delete set: detach all members, resume waiters (S_DELETED).
+ */
+s_status s_waitset_delete(s_pwaitset ws)
+{
+    register s_uint32_t level;
+    s_uint8_t need_schedule = 0;
+
+    if (ws == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    while (ws->count)
+        ws->member[--ws->count]->set = NULL;
+    ws->parent.status = 0;
+    s_irq_enable(level);
+
+    if (!s_waitq_isempty(&ws->parent.suspend_thread))
+    {
+        s_ipc_list_resume_all(&ws->parent.suspend_thread);
+        need_schedule = 1;
+    }
+    s_waitq_deinit(&ws->parent.suspend_thread);
+    ws->parent.flag = 0;
+
+    if (need_schedule)
+        s_sched_switch();
+    return S_OK;
+}
+
+#if START_USING_SEMAPHORE
+/**
+ * @brief Add a semaphore (ready while its count is non-zero).
+ * @return S_OK, S_BUSY (already in a set), S_INVALID (set full), S_DELETED.
+ */
+s_status s_waitset_add_sem(s_pwaitset ws, s_psem sem)
+{
+    return __s_waitset_add(ws, sem ? &sem->parent : NULL, S_WAITSET_SEM);
+}
+#endif
+
+#if START_USING_MESSAGEQUEUE
+/**
+ * @brief Add a message queue (ready while it holds a message).
+ * @return S_OK, S_BUSY (already in a set), S_INVALID (set full), S_DELETED.
+ */
+s_status s_waitset_add_msgqueue(s_pwaitset ws, s_pmsgqueue mq)
+{
+    return __s_waitset_add(ws, mq ? &mq->parent : NULL, S_WAITSET_MSGQUEUE);
+}
+#endif
+
+/**
+ * @brief Remove a member (the semaphore or message queue pointer).
+ * @return S_OK, or S_INVALID if object is not a member of ws.
+ */
+s_status s_waitset_remove(s_pwaitset ws, void *object)
+{
+    if (ws == NULL || object == NULL)
+        return S_NULL;
+    if (((struct ipc_parent *)object)->set != ws)
+        return S_INVALID;
+
+    __s_waitset_detach((struct ipc_parent *)object);
+    return S_OK;
+}
+
+/**
+ * @brief Block until a member is ready and report which one.
+ * @param ready Receives the member (semaphore / message queue pointer).
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return S_OK, S_TIMEOUT, S_DELETED (set deleted), S_UNSUPPORTED.
+ * @note Members are scanned round robin from the one after the last
+ *       reported, so a busy object cannot starve the others. The object is
+ *       not consumed: take / receive it with START_WAITING_NO; that fails
+ *       only if another thread consumed it first.
+ */
+s_status s_waitset_wait(s_pwaitset ws, void **ready, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_uint32_t start_tick = 0;
+    s_uint8_t  n;
+    s_status   ret;
+
+    if (ws == NULL || ready == NULL)
+        return S_NULL;
+
+    while (1)
+    {
+        level = s_irq_disable();
+        if (ws->parent.status == 0)
+        {
+            s_irq_enable(level);
+            return S_DELETED;
+        }
+
+        for (s_uint8_t i = 0; i < ws->count; i++)
+        {
+            n = (s_uint8_t)((ws->next + i) % ws->count);
+            if (__s_waitset_ready(ws, n))
+            {
+                ws->next = (s_uint8_t)(n + 1);
+                *ready   = ws->member[n];
+                s_irq_enable(level);
+                return S_OK;
+            }
+        }
+
+        ret = __s_ipc_wait(&ws->parent, &ws->parent.suspend_thread, level, &timeout, &start_tick);
+        if (ret != S_OK)
+            return ret;
+    }
+}
+#endif /* START_USING_WAITSET */
 
 #endif /* START_USING_IPC */
@@ -0,0 +1,205 @@
+/**
+ * @file ringbuf.c
+ * @brief Lock-free single-producer / single-consumer ring buffer with a
+ *        consumer wakeup trigger level.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Meant for streaming from one interrupt (UART, ADC DMA) into one thread.
+ *   head is written only by the producer and tail only by the consumer, both
+ *   free running (the fill level is head - tail), so the data path takes no
+ *   lock. The IRQ lock is taken only when the consumer goes to sleep and
+ *   when the producer has to wake it: the consumer publishes the fill level
+ *   it waits for in wait_level, the producer samples it after publishing
+ *   head and wakes the thread once the level is reached.
+ */
+
+#include "start.h"
+
+#if START_USING_IPC && START_USING_RINGBUF
+
+/* Order payload vs. index stores (and head store vs. wait_level load). */
+#if defined(__CC_ARM)
+#define S_RB_BARRIER()  __dmb(0xF)
+#else
+#define S_RB_BARRIER()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/**
+ * @brief Copy n elements between the ring (from index idx) and data.
+ * @param to_ring 1: data -> ring (producer), 0: ring -> data (consumer).
+ */
+static void __s_ringbuf_copy(s_pringbuf rb, s_uint32_t idx, void *data,
+                             s_uint32_t n, s_uint8_t to_ring)
+{
+    s_uint32_t off   = idx & rb->mask;
+    s_uint32_t first = rb->mask + 1 - off;
+    s_uint8_t *ring  = rb->buffer + off * rb->elem_size;
+    s_uint8_t *buf   = (s_uint8_t *)data;
+
+    if (first > n)
+        first = n;
+
+    /* Up to two chunks: until the end of the storage, then from its start. */
+    if (to_ring)
+    {
+        s_memcpy(ring, buf, first * rb->elem_size);
+        s_memcpy(rb->buffer, buf + first * rb->elem_size, (n - first) * rb->elem_size);
+    }
+    else
+    {
+        s_memcpy(buf, ring, first * rb->elem_size);
+        s_memcpy(buf + first * rb->elem_size, rb->buffer, (n - first) * rb->elem_size);
+    }
+}
+
+/**
+ * @brief Wake the blocked consumer (producer side, slow path).
+ */
+static void __s_ringbuf_wake(s_pringbuf rb)
+{
+    register s_uint32_t level;
+    s_pthread thread;
+    s_uint8_t need_schedule = 0;
+
+    level = s_irq_disable();
+    thread = rb->wait_level ? s_waitq_first(&rb->parent.suspend_thread) : NULL;
+    if (thread != NULL)
+    {
+        s_timer_stop(&(thread->timer));
+        s_list_delete(&thread->tlist);
+        thread->status = START_THREAD_READY;
+        s_sched_insert_thread(thread);
+        need_schedule = 1;
+    }
+    rb->wait_level = 0;
+    s_irq_enable(level);
+
+    if (need_schedule)
+        s_sched_switch();
+}
+
+/**
+ * @brief Initialize a ring buffer over count * elem_size bytes of storage.
+ * @param count Element capacity, power of two.
+ * @param trigger Fill level that wakes a blocked consumer (1..count).
+ */
+s_status s_ringbuf_init(s_pringbuf rb, void *buffer, s_uint16_t elem_size,
+                        s_uint32_t count, s_uint32_t trigger)
+{
+    if (rb == NULL || buffer == NULL)
+        return S_NULL;
+    if (elem_size == 0 || count == 0 || (count & (count - 1)) ||
+        trigger == 0 || trigger > count)
+        return S_INVALID;
+
+    s_waitq_init(&rb->parent.suspend_thread, START_IPC_FLAG_FIFO);
+    rb->parent.flag   = START_IPC_FLAG_FIFO;
+    rb->parent.status = 1;
+
+    rb->buffer     = (s_uint8_t *)buffer;
+    rb->mask       = count - 1;
+    rb->elem_size  = elem_size;
+    rb->trigger    = trigger;
+    rb->head       = 0;
+    rb->tail       = 0;
+    rb->wait_level = 0;
+    return S_OK;
+}
+
+/**
+ * @brief Elements currently stored (either side).
+ */
+s_uint32_t s_ringbuf_count(s_pringbuf rb)
+{
+    return rb->head - rb->tail;
+}
+
+/**
+ * @brief Producer: append up to n elements, never blocks (ISR safe).
+ * @return Elements written (less than n when the ring is full).
+ */
+s_uint32_t s_ringbuf_write(s_pringbuf rb, const void *data, s_uint32_t n)
+{
+    s_uint32_t head = rb->head;
+    s_uint32_t space = rb->mask + 1 - (head - rb->tail);
+    s_uint32_t wait;
+
+    if (n > space)
+        n = space;
+    if (n == 0)
+        return 0;
+
+    /* Tail was read before the copy: the consumer is done with these slots. */
+    S_RB_BARRIER();
+    __s_ringbuf_copy(rb, head, (void *)data, n, 1);
+    S_RB_BARRIER();
+    rb->head = head + n;
+    S_RB_BARRIER();
+
+    wait = rb->wait_level;
+    if (wait && head + n - rb->tail >= wait)
+        __s_ringbuf_wake(rb);
+    return n;
+}
+
+/**
+ * @brief Consumer: take up to n elements.
+ * @param timeout 0 = no wait, <0 wait forever, >0 tick timeout.
+ * @return Elements read. With a timeout the call sleeps until
+ *         min(n, trigger) elements are stored or the timeout expires, then
+ *         returns whatever is available (possibly 0).
+ */
+s_uint32_t s_ringbuf_read(s_pringbuf rb, void *data, s_uint32_t n, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_pthread  thread;
+    s_uint32_t need;
+    s_uint32_t tail;
+    s_uint32_t used;
+
+    need = n < rb->trigger ? n : rb->trigger;
+    if (need == 0)
+        return 0;
+
+    thread = s_thread_get_blockable();
+    if (rb->head - rb->tail < need && timeout != 0 && thread != NULL)
+    {
+        level = s_irq_disable();
+        rb->wait_level = need;
+        S_RB_BARRIER();
+        /* Recheck after publishing wait_level: the producer may have run. */
+        if (rb->head - rb->tail < need)
+        {
+            s_ipc_suspend(&rb->parent.suspend_thread, thread, rb->parent.flag);
+            if (timeout > 0)
+            {
+                s_timer_ctrl(&(thread->timer), START_TIMER_SET_TIME, &timeout);
+                s_timer_start(&(thread->timer));
+            }
+            s_irq_enable(level);
+            s_sched_switch();
+            level = s_irq_disable();
+        }
+        rb->wait_level = 0;
+        s_irq_enable(level);
+    }
+
+    tail = rb->tail;
+    used = rb->head - tail;
+    if (n > used)
+        n = used;
+    if (n == 0)
+        return 0;
+
+    /* Head was read before the copy: these slots are fully written. */
+    S_RB_BARRIER();
+    __s_ringbuf_copy(rb, tail, data, n, 0);
+    S_RB_BARRIER();
+    rb->tail = tail + n;
+    return n;
+}
+
+#endif /* START_USING_IPC && START_USING_RINGBUF */
@@ -25,13 +25,81 @@ s_uint32_t s_next_thread_sp_p;
 /** PendSV trigger flag (set before requesting context switch). */
 s_uint32_t s_interrupt_flag;
 
+/** Interrupt nesting depth (0: thread context), see s_interrupt_enter(). */
+volatile s_uint8_t s_interrupt_nest;
+/** Scheduler lock nesting depth (0: preemption enabled), see s_sched_lock(). */
+volatile s_uint8_t s_sched_lock_nest;
+/** Set when s_sched_switch() was deferred by an ISR or the scheduler lock. */
+static s_uint8_t s_sched_need_resched;
+
 /** Per-priority ready queues (circular list heads). */
 s_list s_thread_priority_table[START_THREAD_PRIORITY_MAX];
-/** Bitmask indicating which priorities have at least one ready thread. */
+#if START_THREAD_PRIORITY_MAX > 256
+#error "START_THREAD_PRIORITY_MAX must not exceed 256 (s_uint8_t priority)"
+#endif
+
+/**
+ * Bitmask indicating which priorities have at least one ready thread.
+ * With more than 32 priorities it marks non-empty 32-priority groups and
+ * s_thread_ready_table[] holds the per-group priority bits.
+ */
 s_uint32_t s_thread_ready_priority_group = 0;
+#if START_THREAD_PRIORITY_MAX > 32
+s_uint32_t s_thread_ready_table[(START_THREAD_PRIORITY_MAX + 31) / 32];
+#endif
 /** List of threads waiting final reclamation (TERMINATED  DELETED). */
 s_list s_thread_defunct_list;
 
+#if START_USING_RUNTIME_STATS
+/** Counter value at the last accounting point. */
+static s_uint32_t s_sched_runtime_stamp;
+/** CPU time charged to all threads so far (s_cycle_get units). */
+s_uint64_t s_sched_runtime_total;
+
+/**
+ * @brief Charge the time since the last accounting point to thread.
+ */
+s_inline void s_sched_runtime_account(s_pthread thread)
+{
+    s_uint32_t now   = s_cycle_get();
+    s_uint32_t delta = now - s_sched_runtime_stamp;
+
+    s_sched_runtime_stamp  = now;
+    thread->runtime       += delta;
+    s_sched_runtime_total += delta;
+}
+
+/**
+ * @brief Charge the running thread up to now (tick hook, snapshots).
+ * @note Keeps accounting intervals below the 32-bit counter wrap period.
+ */
+void s_sched_runtime_update(void)
+{
+    register s_uint32_t level = s_irq_disable();
+    if (s_current_thread)
+        s_sched_runtime_account(s_current_thread);
+    s_irq_enable(level);
+}
+#endif
+
+/**
+ * @brief Highest ready priority, O(1) via one or two __s_ffs lookups.
+ * @return Priority, or a value >= START_THREAD_PRIORITY_MAX if none is ready.
+ */
+s_inline s_uint32_t s_sched_highest_priority(void)
+{
+#if START_THREAD_PRIORITY_MAX > 32
+    register s_uint32_t number;
+
+    if (s_thread_ready_priority_group == 0)
+        return START_THREAD_PRIORITY_MAX;
+    number = __s_ffs(s_thread_ready_priority_group) - 1;
+    return (number << 5) + __s_ffs(s_thread_ready_table[number]) - 1;
+#else
+    return __s_ffs(s_thread_ready_priority_group) - 1;
+#endif
+}
+
 /**
  * @brief Get current running thread.
  */
@@ -40,12 +108,25 @@ s_pthread s_thread_get(void)
     return s_current_thread;
 }
 
+/**
+ * @brief Current thread if it may block, NULL otherwise.
+ * @note NULL before the scheduler runs and with the scheduler locked: the
+ *       deferred s_sched_switch() would return at once and leave the caller
+ *       queued as a waiter.
+ */
+s_pthread s_thread_get_blockable(void)
+{
+    if (s_sched_lock_nest)
+        return NULL;
+    return s_current_thread;
+}
+
 /**
  * @brief Initialize scheduler internal structures.
  */
 void s_sched_init(void)
 {
-    s_uint8_t i;
+    s_uint32_t i;
     for (i = 0; i < START_THREAD_PRIORITY_MAX; i++)
     {
         s_list_init(&s_thread_priority_table[i]);
@@ -63,7 +144,7 @@ void s_sched_start(void)
     register s_pthread  next_thread;
     register s_uint32_t highest_ready_priority;
 
-    highest_ready_priority = __s_ffs(s_thread_ready_priority_group) - 1;
+    highest_ready_priority = s_sched_highest_priority();
     next_thread = S_LIST_ENTRY(
         s_thread_priority_table[highest_ready_priority].next,
         s_thread,
@@ -75,21 +156,41 @@ void s_sched_start(void)
     next_thread->status         = START_THREAD_RUNNING;
     next_thread->remaining_tick = next_thread->init_tick;
 
+#if START_USING_RUNTIME_STATS
+    s_sched_runtime_stamp = s_cycle_get();
+#endif
+
     s_first_switch_task((s_uint32_t)&next_thread->psp);
 }
 
 /**
  * @brief Attempt a context switch to higher-priority ready thread (if any).
+ * @note Inside an ISR (s_interrupt_nest > 0) or with the scheduler locked
+ *       only a deferred request is recorded; the decision is taken once in
+ *       the outermost s_interrupt_leave() / s_sched_unlock().
  */
 void s_sched_switch(void)
 {
     register s_pthread  next_thread;
     register s_pthread  prev_thread;
     register s_uint32_t highest_ready_priority;
+    register s_uint32_t level;
 
-    highest_ready_priority = __s_ffs(s_thread_ready_priority_group) - 1;
+    if (s_interrupt_nest || s_sched_lock_nest)
+    {
+        s_sched_need_resched = 1;
+        return;
+    }
+
+    /* A tick between the lookup and the switch must not leave a stale pick. */
+    level = s_irq_disable();
+
+    highest_ready_priority = s_sched_highest_priority();
     if (highest_ready_priority >= START_THREAD_PRIORITY_MAX)
+    {
+        s_irq_enable(level);
         return;
+    }
 
     next_thread = S_LIST_ENTRY(
         s_thread_priority_table[highest_ready_priority].next,
@@ -97,9 +198,17 @@ void s_sched_switch(void)
         tlist);
 
     if (s_current_thread == next_thread)
+    {
+        s_irq_enable(level);
         return;
+    }
+
+    S_TRACE(S_TRACE_EV_SWITCH, next_thread, next_thread->current_priority);
 
     prev_thread      = s_current_thread;
+#if START_USING_RUNTIME_STATS
+    s_sched_runtime_account(prev_thread);
+#endif
     s_current_thread = next_thread;
 
     if (prev_thread && prev_thread->status == START_THREAD_RUNNING)
@@ -110,6 +219,8 @@ void s_sched_switch(void)
 
     s_normal_switch_task((s_uint32_t)&prev_thread->psp,
                          (s_uint32_t)&next_thread->psp);
+
+    s_irq_enable(level);
 }
 
 /**
@@ -129,7 +240,13 @@ void s_sched_remove_thread(s_pthread thread)
 
     if (s_list_isempty(&s_thread_priority_table[thread->current_priority]))
     {
+#if START_THREAD_PRIORITY_MAX > 32
+        s_thread_ready_table[thread->number] &= ~(thread->high_mask);
+        if (s_thread_ready_table[thread->number] == 0)
+            s_thread_ready_priority_group &= ~(thread->number_mask);
+#else
         s_thread_ready_priority_group &= ~(thread->number_mask);
+#endif
     }
 
     s_irq_enable(level);
@@ -149,6 +266,9 @@ void s_sched_insert_thread(s_pthread thread)
 
     s_list_insert_before(&(s_thread_priority_table[thread->current_priority]),
                          &(thread->tlist));
+#if START_THREAD_PRIORITY_MAX > 32
+    s_thread_ready_table[thread->number] |= thread->high_mask;
+#endif
     s_thread_ready_priority_group |= thread->number_mask;
 
     s_irq_enable(level);
@@ -167,9 +287,15 @@ void s_thread_yield(void)
 
     level = s_irq_disable();
 
-    /* If only one thread at this priority, no rotation needed. */
-    if (priority_list->next == &(yield_thread->tlist) &&
-        priority_list->prev == &(yield_thread->tlist))
+    /*
+     * No rotation if the thread already left the ready queue to block (a
+     * tick slice expiry can land right before its switch, tlist may sit on
+     * a wait list by then) or if it is alone at this priority.
+     */
+    if ((yield_thread->status != START_THREAD_RUNNING &&
+         yield_thread->status != START_THREAD_READY) ||
+        (priority_list->next == &(yield_thread->tlist) &&
+         priority_list->prev == &(yield_thread->tlist)))
     {
         s_irq_enable(level);
         return;
@@ -186,3 +312,77 @@ void s_thread_yield(void)
     s_sched_switch();
 }
 
+/**
+ * @brief Mark entry of an ISR that may wake threads.
+ * @note Pair with s_interrupt_leave(); rescheduling is deferred until the
+ *       outermost leave so N wakeups cost a single switch decision.
+ */
+void s_interrupt_enter(void)
+{
+    register s_uint32_t level = s_irq_disable();
+    s_interrupt_nest++;
+    s_irq_enable(level);
+}
+
+/**
+ * @brief Mark exit of an ISR; run the pending reschedule on outermost exit.
+ */
+void s_interrupt_leave(void)
+{
+    register s_uint32_t level = s_irq_disable();
+
+    s_interrupt_nest--;
+    if (s_interrupt_nest == 0 && s_sched_lock_nest == 0 && s_sched_need_resched)
+    {
+        s_sched_need_resched = 0;
+        s_sched_switch();
+    }
+
+    s_irq_enable(level);
+}
+
+/**
+ * @brief Current interrupt nesting depth (0 in thread context).
+ */
+s_uint8_t s_interrupt_get_nest(void)
+{
+    return s_interrupt_nest;
+}
+
+/**
+ * @brief Disable preemption (nestable); interrupts stay enabled.
+ * @note The locked section must not block: sleeps and blocking takes return
+ *       S_UNSUPPORTED instead of waiting (non-blocking calls still work).
+ */
+void s_sched_lock(void)
+{
+    register s_uint32_t level = s_irq_disable();
+    s_sched_lock_nest++;
+    s_irq_enable(level);
+}
+
+/**
+ * @brief Re-enable preemption; the outermost unlock runs the pending switch.
+ */
+void s_sched_unlock(void)
+{
+    register s_uint32_t level = s_irq_disable();
+
+    if (s_sched_lock_nest)
+        s_sched_lock_nest--;
+    if (s_sched_lock_nest == 0 && s_interrupt_nest == 0 && s_sched_need_resched)
+    {
+        s_sched_need_resched = 0;
+        s_sched_switch();
+    }
+
+    s_irq_enable(level);
+}
+
+/**
+ * @brief Current scheduler lock nesting depth (0: preemption enabled).
+ */
+s_uint8_t s_sched_get_lock_nest(void)
+{
+    return s_sched_lock_nest;
+}
@@ -1,6 +1,7 @@
 /**
  * @file service.c
- * @brief Minimal formatted output services (lightweight printf).
+ * @brief Minimal formatted output services (lightweight printf) and
+ *        word-wise memory copy / fill.
  * @version 1.0.2
  * @date 2025-08-26
  * @author
@@ -102,3 +103,99 @@ void s_printf(const char *fmt, ...)
     for (int i = 0; i < length; i++)
         s_putc(buffer[i]);
 }
+
+#if defined(__GNUC__)
+/* Word view of arbitrary byte buffers (payloads are plain s_uint8_t arrays). */
+typedef s_uint32_t s_mem_word __attribute__((__may_alias__));
+#else
+typedef s_uint32_t s_mem_word;
+#endif
+
+#define S_MEM_WORD_MASK  (sizeof(s_mem_word) - 1)
+
+/**
+ * @brief Copy size bytes (regions must not overlap).
+ * @note Weak: a port may provide a tuned version (LDM/STM bursts on CM3).
+ *       When dst and src share their alignment, the bytes up to the first
+ *       word boundary are copied singly, then 4-word blocks (one LDM/STM
+ *       pair, or one vector move on a host compiler) and single words; a
+ *       mutually misaligned pair falls back to bytes.
+ * @return dst.
+ */
+__weak void *s_memcpy(void *dst, const void *src, s_uint32_t size)
+{
+    s_uint8_t       *d = (s_uint8_t *)dst;
+    const s_uint8_t *s = (const s_uint8_t *)src;
+
+    if ((((unsigned long)d ^ (unsigned long)s) & S_MEM_WORD_MASK) == 0)
+    {
+        s_mem_word       *dw;
+        const s_mem_word *sw;
+
+        while (((unsigned long)d & S_MEM_WORD_MASK) && size)
+        {
+            *d++ = *s++;
+            size--;
+        }
+
+        dw = (s_mem_word *)d;
+        sw = (const s_mem_word *)s;
+        for (; size >= 4 * sizeof(s_mem_word); size -= 4 * sizeof(s_mem_word))
+        {
+            /* Load the block before storing it: LDM/STM pair or one vector move. */
+            s_mem_word w0 = sw[0], w1 = sw[1], w2 = sw[2], w3 = sw[3];
+            dw[0] = w0;
+            dw[1] = w1;
+            dw[2] = w2;
+            dw[3] = w3;
+            dw += 4;
+            sw += 4;
+        }
+        for (; size >= sizeof(s_mem_word); size -= sizeof(s_mem_word))
+            *dw++ = *sw++;
+
+        d = (s_uint8_t *)dw;
+        s = (const s_uint8_t *)sw;
+    }
+
+    while (size--)
+        *d++ = *s++;
+
+    return dst;
+}
+
+/**
+ * @brief Fill size bytes with the low byte of c.
+ * @note Weak, same word / 4-word block structure as s_memcpy().
+ * @return dst.
+ */
+__weak void *s_memset(void *dst, int c, s_uint32_t size)
+{
+    s_uint8_t  *d = (s_uint8_t *)dst;
+    s_mem_word  w = (s_uint8_t)c * 0x01010101UL;
+    s_mem_word *dw;
+
+    while (((unsigned long)d & S_MEM_WORD_MASK) && size)
+    {
+        *d++ = (s_uint8_t)c;
+        size--;
+    }
+
+    dw = (s_mem_word *)d;
+    for (; size >= 4 * sizeof(s_mem_word); size -= 4 * sizeof(s_mem_word))
+    {
+        dw[0] = w;
+        dw[1] = w;
+        dw[2] = w;
+        dw[3] = w;
+        dw += 4;
+    }
+    for (; size >= sizeof(s_mem_word); size -= sizeof(s_mem_word))
+        *dw++ = w;
+
+    d = (s_uint8_t *)dw;
+    while (size--)
+        *d++ = (s_uint8_t)c;
+
+    return dst;
+}
@@ -13,10 +13,41 @@
 #include "start.h"
 
 /* External scheduler structures */
-extern s_list     s_thread_priority_table[START_THREAD_PRIORITY_MAX];
-extern s_uint32_t s_thread_ready_priority_group;
 extern s_list     s_thread_defunct_list;
 
+#if START_USING_RUNTIME_STATS
+extern s_uint64_t s_sched_runtime_total;
+
+/** All initialized, not yet DELETED threads (runtime statistics). */
+static s_list s_thread_list = { &s_thread_list, &s_thread_list };
+
+/**
+ * @brief Register thread in the global list with a cleared runtime.
+ * @note glist must be unlinked (fresh or after reaching DELETED).
+ */
+static void s_thread_stats_attach(s_pthread thread)
+{
+    register s_uint32_t level = s_irq_disable();
+    thread->runtime = 0;
+    s_list_insert_before(&s_thread_list, &thread->glist);
+    s_irq_enable(level);
+}
+#endif
+
+/**
+ * @brief Derive ready bitmap masks from current_priority.
+ */
+s_inline void s_thread_priority_mask(s_pthread thread)
+{
+#if START_THREAD_PRIORITY_MAX > 32
+    thread->number      = thread->current_priority >> 5;
+    thread->number_mask = 1UL << thread->number;
+    thread->high_mask   = 1UL << (thread->current_priority & 0x1F);
+#else
+    thread->number_mask = 1UL << thread->current_priority;
+#endif
+}
+
 /**
  * @brief Low-level field initialization (no state / ready list insertion).
  */
@@ -24,7 +55,7 @@ void _s_thread_init(s_pthread thread,
                     void *entry,
                     void *stackaddr,
                     s_uint32_t stacksize,
-                    s_int8_t priority,
+                    s_uint8_t priority,
                     s_uint32_t tick)
 {
     s_list_init(&thread->tlist);
@@ -34,7 +65,7 @@ void _s_thread_init(s_pthread thread,
     thread->stacksize        = stacksize;
     thread->current_priority = priority;
     thread->init_priority    = priority;
-    thread->number_mask      = 1UL << thread->current_priority;
+    s_thread_priority_mask(thread);
 
     /* Prepare initial stacked context (PSP). */
     thread->psp = (void *)s_stack_init(entry,
@@ -42,6 +73,10 @@ void _s_thread_init(s_pthread thread,
 
     thread->init_tick      = tick;
     thread->remaining_tick = tick;
+#if START_USING_THREAD_NOTIFY
+    thread->notify_value   = 0;
+    thread->notify_state   = START_NOTIFY_STATE_NONE;
+#endif
 }
 
 /**
@@ -51,17 +86,21 @@ s_status s_thread_init(s_pthread thread,
                        void *entry,
                        void *stackaddr,
                        s_uint32_t stacksize,
-                       s_int8_t priority,
+                       s_uint8_t priority,
                        s_uint32_t tick)
 {
     if (thread == NULL || entry == NULL || stackaddr == NULL || stacksize == 0)
         return S_NULL;
-    if (priority < 0 || priority >= START_THREAD_PRIORITY_MAX)
+    if ((s_uint32_t)priority >= START_THREAD_PRIORITY_MAX)
         return S_INVALID;
     if (tick == 0)
         return S_INVALID;
 
     _s_thread_init(thread, entry, stackaddr, stacksize, priority, tick);
+#if START_USING_RUNTIME_STATS
+    s_list_init(&thread->glist);
+    s_thread_stats_attach(thread);
+#endif
 
     /* Initialize per-thread timer (sleep/timeouts). */
     if (s_timer_init(&(thread->timer), timeout_function, thread, tick) != S_OK)
@@ -88,10 +127,9 @@ s_status s_thread_startup(s_pthread thread)
     thread->current_priority = thread->init_priority;
     thread->status           = START_THREAD_READY;
     thread->remaining_tick   = thread->init_tick;
+    s_thread_priority_mask(thread);
 
-    s_thread_ready_priority_group |= thread->number_mask;
-    s_list_insert_before(&(s_thread_priority_table[thread->current_priority]),
-                         &(thread->tlist));
+    s_sched_insert_thread(thread);
 
     s_irq_enable(level);
     return S_OK;
@@ -120,19 +158,29 @@ s_status s_thread_delete(s_pthread thread)
 
 /**
  * @brief Sleep current thread for specified ticks (blocking).
+ * @return S_OK, S_UNSUPPORTED (no thread context or scheduler locked).
  */
-void s_thread_sleep(s_uint32_t tick)
+s_status s_thread_sleep(s_uint32_t tick)
 {
-    s_pthread thread = s_thread_get();
+    register s_uint32_t level;
+    s_pthread thread = s_thread_get_blockable();
 
+    if (thread == NULL)
+        return S_UNSUPPORTED;
+
+    S_TRACE(S_TRACE_EV_SLEEP, tick, 0);
+    /* Off the ready queue with no timer armed, a preemption would be final. */
+    level = s_irq_disable();
     s_sched_remove_thread(thread);
     thread->status = START_THREAD_SUSPEND;
 
     s_timer_stop(&(thread->timer));
     s_timer_ctrl(&(thread->timer), START_TIMER_SET_TIME, &tick);
     s_timer_start(&(thread->timer));
+    s_irq_enable(level);
 
     s_sched_switch();
+    return S_OK;
 }
 
 /**
@@ -178,8 +226,18 @@ s_status s_thread_ctrl(s_pthread thread, s_uint32_t cmd, void *arg)
     case START_THREAD_SET_PRIORITY:
         if (arg)
         {
+            register s_uint32_t level = s_irq_disable();
+            /* A ready/running thread must move to its new ready queue. */
+            s_uint8_t queued = (thread->status == START_THREAD_READY ||
+                                thread->status == START_THREAD_RUNNING);
+            if (queued)
+                s_sched_remove_thread(thread);
             thread->current_priority = *(s_uint8_t *)arg;
-            thread->number_mask      = 1UL << thread->current_priority;
+            s_thread_priority_mask(thread);
+            S_TRACE(S_TRACE_EV_PRIORITY, thread, thread->current_priority);
+            if (queued)
+                s_sched_insert_thread(thread);
+            s_irq_enable(level);
             return S_OK;
         }
         return S_ERR;
@@ -201,6 +259,9 @@ void s_cleanup_defunct_threads(void)
                                         tlist);
         thread->status = START_THREAD_DELETED;
         s_list_delete(&(thread->tlist));
+#if START_USING_RUNTIME_STATS
+        s_list_delete(&(thread->glist));
+#endif
     }
     s_irq_enable(level);
 }
@@ -237,6 +298,9 @@ s_status s_thread_restart(s_pthread thread)
                    thread->timer.init_tick);
 
     s_timer_init(&(thread->timer), timeout_function, thread, thread->timer.init_tick);
+#if START_USING_RUNTIME_STATS
+    s_thread_stats_attach(thread);
+#endif
 
     thread->status = START_THREAD_READY;
     return s_thread_startup(thread);
@@ -269,3 +333,133 @@ void s_thread_exit(void)
     }
 }
 
+#if START_USING_THREAD_NOTIFY
+/**
+ * @brief Update the notification value of thread and wake it if it waits.
+ * @note The waiter is known directly, so there is no IPC object and no wait
+ *       list: one critical section, at most one ready insert.
+ */
+s_status s_thread_notify(s_pthread thread, s_uint32_t value, s_uint8_t action)
+{
+    register s_uint32_t level;
+    s_uint8_t woken = 0;
+
+    if (thread == NULL)
+        return S_NULL;
+
+    level = s_irq_disable();
+    switch (action)
+    {
+    case START_NOTIFY_SET_BITS:
+        thread->notify_value |= value;
+        break;
+    case START_NOTIFY_INCREMENT:
+        thread->notify_value++;
+        break;
+    case START_NOTIFY_OVERWRITE:
+        thread->notify_value = value;
+        break;
+    default:
+        s_irq_enable(level);
+        return S_INVALID;
+    }
+
+    /* A waiter whose timer already fired is READY: just leave it pending. */
+    if (thread->notify_state == START_NOTIFY_STATE_WAIT &&
+        thread->status == START_THREAD_SUSPEND)
+    {
+        s_timer_stop(&(thread->timer));
+        thread->status = START_THREAD_READY;
+        s_sched_insert_thread(thread);
+        woken = 1;
+    }
+    thread->notify_state = START_NOTIFY_STATE_PENDING;
+    s_irq_enable(level);
+
+    if (woken)
+        s_sched_switch();
+    return S_OK;
+}
+
+/**
+ * @brief Block the calling thread until it is notified.
+ */
+s_status s_thread_notify_wait(s_uint32_t clear, s_uint32_t *value, s_int32_t timeout)
+{
+    register s_uint32_t level;
+    s_pthread thread = s_thread_get_blockable();
+
+    if (thread == NULL)
+        return S_UNSUPPORTED;
+
+    level = s_irq_disable();
+    if (thread->notify_state != START_NOTIFY_STATE_PENDING)
+    {
+        if (timeout == 0)
+        {
+            s_irq_enable(level);
+            return S_TIMEOUT;
+        }
+
+        /* Off the ready queue on no list: only a notify or the timer wakes us. */
+        s_sched_remove_thread(thread);
+        thread->status       = START_THREAD_SUSPEND;
+        thread->notify_state = START_NOTIFY_STATE_WAIT;
+        if (timeout > 0)
+        {
+            s_timer_ctrl(&(thread->timer), START_TIMER_SET_TIME, &timeout);
+            s_timer_start(&(thread->timer));
+        }
+        s_irq_enable(level);
+        s_sched_switch();
+
+        level = s_irq_disable();
+        if (thread->notify_state != START_NOTIFY_STATE_PENDING)
+        {
+            thread->notify_state = START_NOTIFY_STATE_NONE;
+            s_irq_enable(level);
+            return S_TIMEOUT;
+        }
+    }
+
+    if (value)
+        *value = thread->notify_value;
+    thread->notify_value &= ~clear;
+    thread->notify_state  = START_NOTIFY_STATE_NONE;
+    s_irq_enable(level);
+    return S_OK;
+}
+#endif
+
+#if START_USING_RUNTIME_STATS
+/**
+ * @brief Copy runtime counters of all live threads.
+ * @param buf Destination array.
+ * @param max Capacity of buf (entries).
+ * @param total Optional: CPU time charged to all threads since start.
+ * @return Number of live threads (may exceed max; only max are copied).
+ */
+s_uint32_t s_thread_stats_snapshot(s_thread_stat *buf, s_uint32_t max, s_uint64_t *total)
+{
+    register s_uint32_t level;
+    s_uint32_t n = 0;
+
+    level = s_irq_disable();
+    s_sched_runtime_update();
+    for (s_plist p = s_thread_list.next; p != &s_thread_list; p = p->next, n++)
+    {
+        s_pthread t = S_LIST_ENTRY(p, s_thread, glist);
+        if (buf == NULL || n >= max)
+            continue;
+        buf[n].thread           = t;
+        buf[n].runtime          = t->runtime;
+        buf[n].current_priority = t->current_priority;
+        buf[n].status           = t->status;
+    }
+    if (total)
+        *total = s_sched_runtime_total;
+    s_irq_enable(level);
+
+    return n;
+}
+#endif
@@ -16,21 +16,128 @@
 /** Global monotonic tick counter (wraps on overflow). */
 volatile s_uint32_t s_tick;
 
-/** Timer skip-list levels (currently level count fixed by config). */
+#if START_TIMER_WHEEL
+#if (START_TIMER_WHEEL_BITS * START_TIMER_WHEEL_LEVELS) > 31
+#error "START_TIMER_WHEEL_BITS * START_TIMER_WHEEL_LEVELS must not exceed 31"
+#endif
+
+#define S_TIMER_WHEEL_SIZE  (1UL << START_TIMER_WHEEL_BITS)
+#define S_TIMER_WHEEL_MASK  (S_TIMER_WHEEL_SIZE - 1)
+/** Longest delta representable by the wheel; farther timers are re-cascaded. */
+#define S_TIMER_WHEEL_SPAN  (1UL << (START_TIMER_WHEEL_BITS * START_TIMER_WHEEL_LEVELS))
+
+/**
+ * Hierarchical timing wheel. Level 0 slots are one tick wide, each higher
+ * level slot spans a full rotation of the level below. Timers link through
+ * row[0]; start/stop are O(1) and a tick only touches its level 0 slot
+ * (plus a cascade of one higher slot each time level 0 wraps).
+ */
+static s_list s_timer_wheel[START_TIMER_WHEEL_LEVELS][S_TIMER_WHEEL_SIZE];
+
+/** Next tick the wheel has to process. */
+static s_uint32_t s_timer_wheel_base;
+#else
+/**
+ * Timer skip-list levels. Level 0 links every active timer in timeout order;
+ * each higher level links a sparser subset used as express lanes on insert.
+ */
 static s_list s_timer_list[START_TIMER_SKIP_LIST_LEVEL];
 
+/** Insert counter driving deterministic level promotion. */
+static s_uint32_t s_timer_skip_nr;
+#endif
+
 /**
  * @brief Initialize all timer list heads.
  */
 void s_timer_list_init(void)
 {
     int i;
+#if START_TIMER_WHEEL
+    for (i = 0; i < START_TIMER_WHEEL_LEVELS; i++)
+    {
+        for (s_uint32_t j = 0; j < S_TIMER_WHEEL_SIZE; j++)
+            s_list_init(&s_timer_wheel[i][j]);
+    }
+    s_timer_wheel_base = s_tick;
+#else
     for (i = 0; i < START_TIMER_SKIP_LIST_LEVEL; i++)
     {
         s_list_init(&s_timer_list[i]);
     }
+#endif
+}
+
+/**
+ * @brief Move every node of list src to the tail of list dst.
+ */
+s_inline void s_timer_list_move(s_plist dst, s_plist src)
+{
+    if (s_list_isempty(src))
+        return;
+
+    src->next->prev = dst->prev;
+    dst->prev->next = src->next;
+    src->prev->next = dst;
+    dst->prev       = src->prev;
+    s_list_init(src);
+}
+
+#if START_TIMER_WHEEL
+/**
+ * @brief Link timer into the wheel slot matching its timeout_tick.
+ * @note Called with IRQs disabled.
+ */
+static void s_timer_wheel_add(s_ptimer timer)
+{
+    s_uint32_t expires = timer->timeout_tick;
+    s_uint32_t delta   = expires - s_timer_wheel_base;
+    int lvl;
+
+    /* Already due: process on the next wheel step. */
+    if ((s_int32_t)delta < 0)
+    {
+        expires = s_timer_wheel_base;
+        delta   = 0;
+    }
+
+    for (lvl = 0; lvl < START_TIMER_WHEEL_LEVELS - 1; lvl++)
+    {
+        if (delta < (1UL << (START_TIMER_WHEEL_BITS * (lvl + 1))))
+            break;
+    }
+
+    /* Beyond the wheel span: park in the farthest slot, re-cascade later. */
+    if (delta >= S_TIMER_WHEEL_SPAN)
+        expires = s_timer_wheel_base + S_TIMER_WHEEL_SPAN - 1;
+
+    s_list_insert_before(
+        &s_timer_wheel[lvl][(expires >> (START_TIMER_WHEEL_BITS * lvl)) & S_TIMER_WHEEL_MASK],
+        &timer->row[0]);
 }
 
+/**
+ * @brief Redistribute the current slot of level lvl into lower levels.
+ * @return Slot index processed (0 means the next level must cascade too).
+ */
+static s_uint32_t s_timer_wheel_cascade(int lvl)
+{
+    s_uint32_t idx = (s_timer_wheel_base >> (START_TIMER_WHEEL_BITS * lvl)) & S_TIMER_WHEEL_MASK;
+    s_list     pending;
+
+    s_list_init(&pending);
+    s_timer_list_move(&pending, &s_timer_wheel[lvl][idx]);
+
+    while (!s_list_isempty(&pending))
+    {
+        s_ptimer timer = S_LIST_ENTRY(pending.next, s_timer, row[0]);
+        s_list_delete(&timer->row[0]);
+        s_timer_wheel_add(timer);
+    }
+    return idx;
+}
+#endif
+
 /**
  * @brief Convert milliseconds to system ticks.
  * @param ms Millisecond value.
@@ -102,6 +209,13 @@ void s_tick_increase(void)
 
     thread = s_current_thread;
 
+    /* Batch every wakeup of this tick into one switch decision on leave. */
+    s_interrupt_enter();
+
+#if START_USING_RUNTIME_STATS
+    s_sched_runtime_update();
+#endif
+
     /* Decrease remaining time slice atomically. */
     level = s_irq_disable();
     --thread->remaining_tick;
@@ -118,6 +232,8 @@ void s_tick_increase(void)
 
     /* Process timer expirations (callbacks executed outside critical section). */
     s_timer_check();
+
+    s_interrupt_leave();
 }
 
 /**
@@ -183,16 +299,41 @@ s_status s_timer_start(s_ptimer timer)
     /* Compute absolute expiration (handles wrap via signed diff on check). */
     timer->timeout_tick = s_tick_get() + timer->init_tick;
 
-    /* Ordered insertion in level 0 list by timeout_tick. */
-    s_plist p = &s_timer_list[0];
-    while (p->next != &s_timer_list[0])
+#if START_TIMER_WHEEL
+    s_timer_wheel_add(timer);
+#else
+    /*
+     * Skip-list search from the sparsest level down. row_head[lvl] ends on the
+     * last node of level lvl that expires no later than the new timer.
+     */
+    s_plist row_head[START_TIMER_SKIP_LIST_LEVEL];
+    s_plist p = &s_timer_list[START_TIMER_SKIP_LIST_LEVEL - 1];
+    for (int lvl = START_TIMER_SKIP_LIST_LEVEL - 1; lvl >= 0; lvl--)
+    {
+        while (p->next != &s_timer_list[lvl])
+        {
+            s_ptimer next_timer = S_LIST_ENTRY(p->next, s_timer, row[lvl]);
+            if ((s_int32_t)(next_timer->timeout_tick - timer->timeout_tick) > 0)
+                break;
+            p = p->next;
+        }
+        row_head[lvl] = p;
+        /* Drop one level: list heads and timer rows are both arrays. */
+        if (lvl > 0)
+            p = p - 1;
+    }
+
+    /* Always link level 0; promote every (MASK+1)^k-th insert to level k. */
+    s_list_insert_after(row_head[0], &timer->row[0]);
+    s_uint32_t tst_nr = ++s_timer_skip_nr;
+    for (int lvl = 1; lvl < START_TIMER_SKIP_LIST_LEVEL; lvl++)
     {
-        s_ptimer next_timer = S_LIST_ENTRY(p->next, s_timer, row[0]);
-        if ((s_int32_t)(next_timer->timeout_tick - timer->timeout_tick) > 0)
+        if (tst_nr & START_TIMER_SKIP_LIST_MASK)
             break;
-        p = p->next;
+        s_list_insert_after(row_head[lvl], &timer->row[lvl]);
+        tst_nr /= (START_TIMER_SKIP_LIST_MASK + 1);
     }
-    s_list_insert_after(p, &timer->row[0]);
+#endif
 
     s_irq_enable(level);
     return S_OK;
@@ -209,6 +350,25 @@ void s_timer_check(void)
 
     s_list_init(&expired_list);
 
+#if START_TIMER_WHEEL
+    /* Step the wheel up to the current tick (more than one after a stall). */
+    while ((s_int32_t)(s_tick - s_timer_wheel_base) >= 0)
+    {
+        level = s_irq_disable();
+        s_uint32_t idx = s_timer_wheel_base & S_TIMER_WHEEL_MASK;
+        if (idx == 0)
+        {
+            for (int lvl = 1; lvl < START_TIMER_WHEEL_LEVELS; lvl++)
+            {
+                if (s_timer_wheel_cascade(lvl) != 0)
+                    break;
+            }
+        }
+        s_timer_list_move(&expired_list, &s_timer_wheel[0][idx]);
+        s_timer_wheel_base++;
+        s_irq_enable(level);
+    }
+#else
     level = s_irq_disable();
     while (!s_list_isempty(&s_timer_list[0]))
     {
@@ -217,6 +377,9 @@ void s_timer_check(void)
 
         if ((s_int32_t)(s_tick - timer->timeout_tick) >= 0)
         {
+            /* Expired timers are at the front of every level. */
+            for (int i = 1; i < START_TIMER_SKIP_LIST_LEVEL; i++)
+                s_list_delete(&timer->row[i]);
             s_list_delete(node);
             s_list_insert_before(&expired_list, node);
         }
@@ -227,6 +390,7 @@ void s_timer_check(void)
         }
     }
     s_irq_enable(level);
+#endif
 
     /* Callbacks executed out of critical section to allow preemption. */
     while (!s_list_isempty(&expired_list))
@@ -235,12 +399,129 @@ void s_timer_check(void)
         s_ptimer timer = S_LIST_ENTRY(node, s_timer, row[0]);
 
         s_list_delete(node);
+        S_TRACE(S_TRACE_EV_TIMER, timer, 0);
 
         if (timer->timeout_func)
             timer->timeout_func(timer->p);
     }
 }
 
+#if START_USING_TICKLESS
+#if START_TIMER_WHEEL
+/**
+ * @brief Check whether no timer is armed beyond the current level 0 rotation.
+ * @param idx Current level 0 slot; slots below it belong to the next rotation.
+ */
+static int s_timer_wheel_idle(s_uint32_t idx)
+{
+    for (s_uint32_t j = 0; j < idx; j++)
+    {
+        if (!s_list_isempty(&s_timer_wheel[0][j]))
+            return 0;
+    }
+    for (int lvl = 1; lvl < START_TIMER_WHEEL_LEVELS; lvl++)
+    {
+        for (s_uint32_t j = 0; j < S_TIMER_WHEEL_SIZE; j++)
+        {
+            if (!s_list_isempty(&s_timer_wheel[lvl][j]))
+                return 0;
+        }
+    }
+    return 1;
+}
+#endif
+
+/**
+ * @brief Ticks until the earliest armed timer expires.
+ * @return 0 if a timer is already due, START_TICKLESS_FOREVER if none armed.
+ * @note Call with IRQs disabled. The wheel engine may report an earlier
+ *       point (next level 0 wrap) where higher slots must be cascaded.
+ */
+s_uint32_t s_timer_next_timeout(void)
+{
+#if START_TIMER_WHEEL
+    s_uint32_t idx = s_timer_wheel_base & S_TIMER_WHEEL_MASK;
+    s_uint32_t i;
+
+    for (i = 0; i < S_TIMER_WHEEL_SIZE - idx; i++)
+    {
+        if (!s_list_isempty(&s_timer_wheel[0][idx + i]))
+            break;
+    }
+    /* No level 0 timer before the wrap: wake there to cascade, if needed. */
+    if (i == S_TIMER_WHEEL_SIZE - idx && s_timer_wheel_idle(idx))
+        return START_TICKLESS_FOREVER;
+
+    s_int32_t delta = (s_int32_t)(s_timer_wheel_base + i - s_tick);
+    return delta > 0 ? (s_uint32_t)delta : 0;
+#else
+    if (s_list_isempty(&s_timer_list[0]))
+        return START_TICKLESS_FOREVER;
+
+    s_ptimer timer = S_LIST_ENTRY(s_timer_list[0].next, s_timer, row[0]);
+    s_int32_t delta = (s_int32_t)(timer->timeout_tick - s_tick);
+    return delta > 0 ? (s_uint32_t)delta : 0;
+#endif
+}
+
+/**
+ * @brief Advance the tick counter by ticks that elapsed with SysTick stopped.
+ * @param ticks Whole ticks slept (not counting a pending tick interrupt).
+ */
+void s_tick_compensate(s_uint32_t ticks)
+{
+    register s_uint32_t level = s_irq_disable();
+    s_tick += ticks;
+    s_irq_enable(level);
+}
+
+/**
+ * @brief Split the cycles of an interrupted tickless sleep on the tick grid.
+ * @param cycles_per_tick Counter cycles per tick.
+ * @param into Cycles of the running tick already gone when the sleep began.
+ * @param elapsed Cycles counted since the sleep began.
+ * @param reload Receives the counter reload (cycles - 1) that ends on the
+ *        next tick boundary, so the tick phase survives the sleep.
+ * @return Tick boundaries crossed.
+ * @note A boundary one cycle away is counted now and the reload targets the
+ *       one after it: a reload of 0 would stop a SysTick style counter.
+ */
+s_uint32_t s_tickless_split(s_uint32_t cycles_per_tick, s_uint32_t into,
+                            s_uint32_t elapsed, s_uint32_t *reload)
+{
+    s_uint32_t done      = into + elapsed;
+    s_uint32_t completed = done / cycles_per_tick;
+    s_uint32_t left      = cycles_per_tick - done % cycles_per_tick;
+
+    if (left == 1)
+    {
+        completed++;
+        left += cycles_per_tick;
+    }
+    *reload = left - 1;
+    return completed;
+}
+
+/**
+ * @brief Idle hook: stop the periodic tick until the next timer expiry.
+ * @note Expiry itself is delivered by the (pending) tick interrupt, which
+ *       runs s_tick_increase() as soon as IRQs are re-enabled.
+ */
+void s_tickless_idle(void)
+{
+    register s_uint32_t level = s_irq_disable();
+    s_uint32_t ticks = s_timer_next_timeout();
+
+    if (ticks >= START_TICKLESS_MIN_TICKS)
+    {
+        if (ticks > START_TICKLESS_MAX_TICKS)
+            ticks = START_TICKLESS_MAX_TICKS;
+        s_tick_compensate(s_cpu_tickless_sleep(ticks));
+    }
+    s_irq_enable(level);
+}
+#endif
+
 /**
  * @brief Default timeout callback used for thread sleep timers.
  * @param p Thread pointer.
@@ -251,8 +532,12 @@ void timeout_function(void *p)
     if (thread == NULL)
         return;
 
+    register s_uint32_t level = s_irq_disable();
+    /* Leave the IPC wait list on a timed-out wait (no-op after a sleep). */
+    s_list_delete(&thread->tlist);
     thread->status = START_THREAD_READY;
     s_sched_insert_thread(thread);
+    s_irq_enable(level);
     s_sched_switch();
 }
 
@@ -0,0 +1,117 @@
+/**
+ * @file trace.c
+ * @brief Binary kernel event trace in a lock-free RAM ring buffer.
+ * @version 1.0.2
+ * @date 2026-10-17
+ * author
+ *   StitchLilo626
+ * @note
+ *   Writers (threads and ISRs) reserve a slot with one atomic increment of
+ *   head and fill the 16-byte record in place; the oldest records are
+ *   overwritten. Each record carries the buffer lap it was written in, so a
+ *   decoder reading a live dump drops slots that were torn or already
+ *   overwritten. Decode with tools/trace2chrome.py.
+ */
+
+#include "start.h"
+
+#if START_USING_TRACE
+
+#if (START_TRACE_EVENTS & (START_TRACE_EVENTS - 1)) || START_TRACE_EVENTS > 32768
+#error "START_TRACE_EVENTS must be a power of two not above 32768"
+#endif
+
+s_trace_buffer s_trace_buf;
+
+/**
+ * @brief Reserve the next event index (single atomic read-modify-write).
+ */
+s_inline s_uint32_t s_trace_reserve(void)
+{
+#if defined(__CC_ARM)
+    s_uint32_t idx;
+    do
+    {
+        idx = __ldrex(&s_trace_buf.head);
+    } while (__strex(idx + 1, &s_trace_buf.head));
+    return idx;
+#else
+    return __atomic_fetch_add(&s_trace_buf.head, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @brief Keep the compiler from moving stores across this point.
+ */
+#if defined(__CC_ARM)
+#define s_trace_barrier() __schedule_barrier()
+#else
+#define s_trace_barrier() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/**
+ * @brief Reset the buffer header and start recording.
+ */
+void s_trace_init(void)
+{
+    s_trace_buf.magic    = S_TRACE_MAGIC;
+    s_trace_buf.version  = S_TRACE_VERSION;
+    s_trace_buf.size     = START_TRACE_EVENTS;
+    s_trace_buf.clock_hz = START_TRACE_CLOCK_HZ;
+    s_trace_buf.head     = 0;
+    s_trace_buf.enable   = 1;
+}
+
+/**
+ * @brief Resume recording.
+ */
+void s_trace_start(void)
+{
+    s_trace_buf.enable = 1;
+}
+
+/**
+ * @brief Freeze the buffer (e.g. right after a detected latency spike).
+ */
+void s_trace_stop(void)
+{
+    s_trace_buf.enable = 0;
+}
+
+/**
+ * @brief Append one event (threads and ISRs, no lock taken).
+ */
+void s_trace_record(s_uint8_t id, s_uint32_t object, s_uint8_t arg)
+{
+    s_trace_event *ev;
+    s_uint32_t     idx;
+
+    if (!s_trace_buf.enable)
+        return;
+
+    idx = s_trace_reserve();
+    ev  = &s_trace_buf.events[idx & (START_TRACE_EVENTS - 1)];
+
+    ev->timestamp = s_cycle_get();
+    ev->thread    = (s_uint32_t)(unsigned long)s_current_thread;
+    ev->object    = object;
+    ev->id        = id;
+    ev->prio      = s_current_thread ? s_current_thread->current_priority : 0;
+    ev->arg       = arg;
+    /* lap marks the record complete: it must land after the payload. */
+    s_trace_barrier();
+    ev->lap       = (s_uint8_t)(idx / START_TRACE_EVENTS);
+}
+
+/**
+ * @brief Stream the whole buffer as raw bytes through s_putc().
+ */
+void s_trace_dump(void)
+{
+    const char *p = (const char *)&s_trace_buf;
+
+    for (s_uint32_t i = 0; i < sizeof(s_trace_buf); i++)
+        s_putc(p[i]);
+}
+
+#endif /* START_USING_TRACE */
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+trace2chrome.py - convert a StaRT trace buffer into Chrome trace JSON.
+
+Input is either a raw memory dump of the s_trace_buf symbol, e.g.
+
+    (gdb) dump binary value trace.bin s_trace_buf
+
+or a captured byte stream from s_trace_dump() (UART log); the decoder scans
+for the "STRC" header, so surrounding console text is ignored.
+
+Open the output in chrome://tracing or https://ui.perfetto.dev. Each thread
+gets a track with "run" slices between switches; IPC, sleep and priority
+changes are instant events on the thread that issued them, timer expiries
+appear on the "tick / timer" track.
+
+usage: trace2chrome.py trace.bin [trace.json]
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = 0x43525453
+VERSION = 1
+HEADER = struct.Struct("<IHHIII")   # magic version size clock_hz head enable
+EVENT = struct.Struct("<IIIBBBB")   # timestamp thread object id prio arg lap
+
+EV_SWITCH = 0x01
+EV_TIMER = 0x09
+EV_PRIORITY = 0x0A
+
+EV_NAMES = {
+    0x01: "switch",
+    0x02: "sleep",
+    0x03: "suspend",
+    0x04: "sem release",
+    0x05: "mutex take",
+    0x06: "mutex release",
+    0x07: "mq send",
+    0x08: "mq recv",
+    0x09: "timer expire",
+    0x0A: "priority",
+}
+
+TID_KERNEL = 0
+
+
+def find_header(data):
+    """Return (offset, header tuple) of the first plausible trace header."""
+    pos = 0
+    key = struct.pack("<I", MAGIC)
+    while True:
+        pos = data.find(key, pos)
+        if pos < 0 or pos + HEADER.size > len(data):
+            raise ValueError("no StaRT trace header found")
+        hdr = HEADER.unpack_from(data, pos)
+        size = hdr[2]
+        if hdr[1] == VERSION and size and size & (size - 1) == 0:
+            return pos, hdr
+        pos += 1
+
+
+def decode(data):
+    """Yield events in record order, skipping torn or overwritten slots."""
+    pos, (_, _, size, clock_hz, head, _) = find_header(data)
+    base = pos + HEADER.size
+    need = base + size * EVENT.size
+    if need > len(data):
+        raise ValueError("truncated dump: %d of %d bytes" % (len(data), need))
+
+    first = head - size if head > size else 0
+    events = []
+    for idx in range(first, head):
+        ts, thread, obj, ev_id, prio, arg, lap = EVENT.unpack_from(
+            data, base + (idx % size) * EVENT.size)
+        if lap != (idx // size) & 0xFF or ev_id not in EV_NAMES:
+            continue
+        events.append((ts, thread, obj, ev_id, prio, arg))
+    return clock_hz, head - first, events
+
+
+def to_chrome(clock_hz, events):
+    out = []
+    names = {}
+    scale = 1e6 / clock_hz
+    now = 0
+    last_ts = None
+    running = None        # (tid, start_us)
+
+    def name_thread(tid, prio):
+        if tid not in names:
+            names[tid] = "thread 0x%08x (prio %d)" % (tid, prio)
+
+    for ts, thread, obj, ev_id, prio, arg in events:
+        # Unwrap the 32-bit counter (gaps must stay below one wrap period).
+        if last_ts is not None:
+            now += ((ts - last_ts) & 0xFFFFFFFF) * scale
+        last_ts = ts
+
+        if thread:
+            name_thread(thread, prio)
+        if running is None and thread:
+            running = (thread, now)
+
+        if ev_id == EV_SWITCH:
+            if running is not None:
+                out.append({"name": "run", "ph": "X", "pid": 1,
+                            "tid": running[0], "ts": running[1],
+                            "dur": max(now - running[1], 0.001),
+                            "args": {"prio": prio}})
+            name_thread(obj, arg)
+            running = (obj, now)
+            continue
+
+        if ev_id == EV_TIMER:
+            tid, label = TID_KERNEL, EV_NAMES[ev_id]
+        elif ev_id == EV_PRIORITY:
+            name_thread(obj, arg)
+            tid, label = obj, "priority -> %d" % arg
+        else:
+            tid, label = thread, EV_NAMES[ev_id]
+
+        out.append({"name": label, "ph": "i", "s": "t", "pid": 1,
+                    "tid": tid, "ts": now,
+                    "args": {"object": "0x%08x" % obj, "arg": arg,
+                             "thread": "0x%08x" % thread, "prio": prio}})
+
+    if running is not None:
+        out.append({"name": "run", "ph": "X", "pid": 1, "tid": running[0],
+                    "ts": running[1], "dur": max(now - running[1], 0.001)})
+
+    meta = [{"name": "process_name", "ph": "M", "pid": 1,
+             "args": {"name": "StaRT"}},
+            {"name": "thread_name", "ph": "M", "pid": 1, "tid": TID_KERNEL,
+             "args": {"name": "tick / timer"}}]
+    for tid, label in names.items():
+        meta.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                     "args": {"name": label}})
+    return {"traceEvents": meta + out, "displayTimeUnit": "ns"}
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    try:
+        clock_hz, total, events = decode(data)
+    except ValueError as e:
+        sys.stderr.write("trace2chrome: %s\n" % e)
+        return 1
+
+    trace = to_chrome(clock_hz, events)
+    if len(argv) > 2:
+        with open(argv[2], "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    sys.stderr.write("trace2chrome: %d events decoded, %d dropped\n"
+                     % (len(events), total - len(events)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))